@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tiledcpp/detail/parse_helpers.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/detail/parse_helpers.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/detail/parse_helpers.cpp.o.d"
+  "/root/repo/tiledcpp/detail/xml_reader.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/detail/xml_reader.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/detail/xml_reader.cpp.o.d"
+  "/root/repo/tiledcpp/parallel.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/parallel.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/parallel.cpp.o.d"
+  "/root/repo/tiledcpp/tiledcpp.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/tiledcpp.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/tiledcpp.cpp.o.d"
+  "/root/repo/tiledcpp/types/image.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/types/image.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/types/image.cpp.o.d"
+  "/root/repo/tiledcpp/types/math.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/types/math.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/types/math.cpp.o.d"
+  "/root/repo/tiledcpp/types/name.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/types/name.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/types/name.cpp.o.d"
+  "/root/repo/tiledcpp/types/properties.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/types/properties.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/types/properties.cpp.o.d"
+  "/root/repo/tiledcpp/types/string_store.cpp" "CMakeFiles/TiledCpp.dir/tiledcpp/types/string_store.cpp.o" "gcc" "CMakeFiles/TiledCpp.dir/tiledcpp/types/string_store.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,27 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/TiledCpp.dir/tiledcpp/detail/parse_helpers.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/detail/parse_helpers.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/detail/xml_reader.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/detail/xml_reader.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/parallel.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/parallel.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/tiledcpp.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/tiledcpp.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/image.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/image.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/math.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/math.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/name.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/name.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/properties.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/properties.cpp.o.d"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/string_store.cpp.o"
+  "CMakeFiles/TiledCpp.dir/tiledcpp/types/string_store.cpp.o.d"
+  "libTiledCpp.a"
+  "libTiledCpp.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TiledCpp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tiledcpp_benchmarks/allocation_benchmarks.cpp" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/allocation_benchmarks.cpp.o" "gcc" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/allocation_benchmarks.cpp.o.d"
+  "/root/repo/tiledcpp_benchmarks/array2d_benchmarks.cpp" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/array2d_benchmarks.cpp.o" "gcc" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/array2d_benchmarks.cpp.o.d"
+  "/root/repo/tiledcpp_benchmarks/layer_storage_benchmarks.cpp" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/layer_storage_benchmarks.cpp.o" "gcc" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/layer_storage_benchmarks.cpp.o.d"
+  "/root/repo/tiledcpp_benchmarks/load_benchmarks.cpp" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/load_benchmarks.cpp.o" "gcc" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/load_benchmarks.cpp.o.d"
+  "/root/repo/tiledcpp_benchmarks/main.cpp" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/main.cpp.o" "gcc" "tiledcpp_benchmarks/CMakeFiles/TiledCppBenchmarks.dir/main.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench_build/CMakeFiles/TiledCpp.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "../TiledCppBenchmarks"
+  "../TiledCppBenchmarks.pdb"
+  "CMakeFiles/TiledCppBenchmarks.dir/allocation_benchmarks.cpp.o"
+  "CMakeFiles/TiledCppBenchmarks.dir/allocation_benchmarks.cpp.o.d"
+  "CMakeFiles/TiledCppBenchmarks.dir/array2d_benchmarks.cpp.o"
+  "CMakeFiles/TiledCppBenchmarks.dir/array2d_benchmarks.cpp.o.d"
+  "CMakeFiles/TiledCppBenchmarks.dir/layer_storage_benchmarks.cpp.o"
+  "CMakeFiles/TiledCppBenchmarks.dir/layer_storage_benchmarks.cpp.o.d"
+  "CMakeFiles/TiledCppBenchmarks.dir/load_benchmarks.cpp.o"
+  "CMakeFiles/TiledCppBenchmarks.dir/load_benchmarks.cpp.o.d"
+  "CMakeFiles/TiledCppBenchmarks.dir/main.cpp.o"
+  "CMakeFiles/TiledCppBenchmarks.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TiledCppBenchmarks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -1,6 +1,8 @@
 #include "tiledcpp/detail/parse_helpers.hpp"
 
+#include <algorithm>
 #include <charconv>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 
@@ -19,6 +21,18 @@ std::string tpp::detail::resolvePath(const std::string& base, const std::string&
     }
 }
 
+std::string tpp::detail::joinPath(const std::string& base, const std::string& path)
+{
+    std::filesystem::path b { path };
+
+    if (b.is_absolute())
+    {
+        return path;
+    }
+
+    return (std::filesystem::path(base) / b).lexically_normal().string();
+}
+
 std::string tpp::detail::getDirectory(const std::string& path)
 {
     return std::filesystem::path(path).parent_path().string();
@@ -36,19 +50,28 @@ std::string tpp::detail::makePreferredPath(const std::string& path)
 
 std::string tpp::detail::getFileContents(const std::string& path)
 {
-    std::ifstream file { path };
+    std::string out {};
+    readFileContents(path, out);
+    return out;
+}
+
+bool tpp::detail::readFileContents(const std::string& path, std::string& out)
+{
+    out.clear();
+
+    std::ifstream file { path, std::ios::binary };
 
     if (file)
     {
         file.seekg(0, std::ios::end);
         size_t size = file.tellg();
-        std::string out(size, {});
+        out.resize(size);
         file.seekg(0);
         file.read(out.data(), size);
-        return out;
+        return true;
     }
 
-    return {};
+    return false;
 }
 
 std::optional<int> tpp::detail::parseInt(std::string_view view)
@@ -137,4 +160,261 @@ std::vector<uint32_t> tpp::detail::parseCSV(std::string_view view)
     }
 
     return out;
-}
\ No newline at end of file
+}
+
+namespace
+{
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+std::string_view trim(std::string_view view)
+{
+    while (!view.empty() && isSpace(view.front()))
+        view.remove_prefix(1);
+    while (!view.empty() && isSpace(view.back()))
+        view.remove_suffix(1);
+    return view;
+}
+
+// The part of region inside a grid of grid_size
+tpp::URect clampRegion(const tpp::UVec2& grid_size, const tpp::URect& region)
+{
+    tpp::URect out {};
+    out.start.x = std::min(region.start.x, grid_size.x);
+    out.start.y = std::min(region.start.y, grid_size.y);
+    out.size.x = std::min(region.size.x, grid_size.x - out.start.x);
+    out.size.y = std::min(region.size.y, grid_size.y - out.start.y);
+    return out;
+}
+
+// Returns the 6 bit value of a base64 character, or 0xFF for padding and invalid characters
+uint8_t base64Value(char c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
+    return 0xFF;
+}
+
+// Decodes count bytes starting at byte offset of the decoded stream, jumping straight to the right 4 character group.
+// Bytes past the end of the data are left untouched
+void decodeBase64Bytes(std::string_view view, size_t offset, size_t count, uint8_t* out)
+{
+    size_t group = offset / 3;
+    size_t skip = offset % 3;
+
+    for (size_t char_pos = group * 4; count > 0 && char_pos + 4 <= view.size(); char_pos += 4)
+    {
+        uint32_t bits = 0;
+        uint32_t valid = 0;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            uint8_t value = base64Value(view[char_pos + i]);
+            if (value == 0xFF)
+                break;
+
+            bits |= static_cast<uint32_t>(value) << (18 - 6 * i);
+            ++valid;
+        }
+
+        uint8_t decoded[3] = {
+            static_cast<uint8_t>(bits >> 16),
+            static_cast<uint8_t>(bits >> 8),
+            static_cast<uint8_t>(bits)
+        };
+
+        size_t available = valid > 1 ? valid - 1 : 0;
+        for (size_t i = skip; i < available && count > 0; ++i, --count)
+        {
+            *out++ = decoded[i];
+        }
+
+        skip = 0;
+    }
+}
+
+}
+
+std::vector<uint32_t> tpp::detail::parseCSVRegion(std::string_view view, const UVec2& grid_size, const URect& region)
+{
+    std::vector<uint32_t> out {};
+    parseCSVRegion(view, grid_size, region, out);
+    return out;
+}
+
+void tpp::detail::parseCSVRegion(std::string_view view, const UVec2& grid_size, const URect& requested_region, std::vector<uint32_t>& out)
+{
+    URect region = clampRegion(grid_size, requested_region);
+
+    out.clear();
+    out.reserve(static_cast<size_t>(region.size.x) * region.size.y);
+
+    view = trim(view);
+
+    // Tiled writes every row on its own line: whole rows are skipped by jumping from line break to line break.
+    // Data written on a single line falls back to counting the commas
+    bool one_row_per_line = view.find('\n') != std::string_view::npos;
+
+    // Skipping only needs to find the separators, values are never parsed
+    auto skip_past = [&view](char separator, size_t count)
+    {
+        for (; count > 0 && !view.empty(); --count)
+        {
+            auto next = view.find(separator);
+            view.remove_prefix(next == std::string_view::npos ? view.size() : next + 1);
+        }
+    };
+
+    auto next_value = [&view]()
+    {
+        auto next_comma = view.find(',');
+        std::string_view token = trim(view.substr(0, next_comma));
+        view.remove_prefix(next_comma == std::string_view::npos ? view.size() : next_comma + 1);
+
+        return parseIndex(token);
+    };
+
+    uint32_t columns_after = grid_size.x - region.start.x - region.size.x;
+
+    if (one_row_per_line)
+        skip_past('\n', region.start.y);
+    else
+        skip_past(',', static_cast<size_t>(region.start.y) * grid_size.x);
+
+    for (uint32_t y = 0; y < region.size.y; ++y)
+    {
+        skip_past(',', region.start.x);
+
+        for (uint32_t x = 0; x < region.size.x; ++x)
+        {
+            // Stop at missing or malformed values, callers can compare the size to detect it
+            auto value = next_value();
+            if (!value)
+            {
+                return;
+            }
+
+            out.emplace_back(value.value());
+        }
+
+        // The rows after the region are never touched
+        if (y + 1 < region.size.y && columns_after > 0)
+        {
+            if (one_row_per_line)
+                skip_past('\n', 1);
+            else
+                skip_past(',', columns_after);
+        }
+    }
+}
+
+std::vector<uint32_t> tpp::detail::parseBase64Region(std::string_view view, const UVec2& grid_size, const URect& region)
+{
+    std::vector<uint32_t> out {};
+    parseBase64Region(view, grid_size, region, out);
+    return out;
+}
+
+void tpp::detail::parseBase64Region(std::string_view view, const UVec2& grid_size, const URect& requested_region, std::vector<uint32_t>& out)
+{
+    URect region = clampRegion(grid_size, requested_region);
+
+    out.clear();
+    view = trim(view);
+
+    // Offsets into the encoded text only work without line breaks inside the data
+    std::string stripped {};
+    if (view.find_first_of(" \n\r\t") != std::string_view::npos)
+    {
+        stripped.reserve(view.size());
+        for (char c : view)
+        {
+            if (!isSpace(c))
+                stripped.push_back(c);
+        }
+        view = stripped;
+    }
+
+    if (region.size.x == 0 || region.size.y == 0)
+    {
+        return;
+    }
+
+    // Return nothing if the data is too short to contain the whole region
+    size_t padding = view.size() - view.find_last_not_of('=') - 1;
+    size_t decoded_size = view.size() / 4 * 3 - std::min<size_t>(padding, 2);
+    size_t region_end = (static_cast<size_t>(region.start.y + region.size.y - 1) * grid_size.x + region.start.x + region.size.x) * 4;
+
+    if (view.empty() || decoded_size < region_end)
+    {
+        return;
+    }
+
+    out.assign(static_cast<size_t>(region.size.x) * region.size.y, 0);
+
+    for (uint32_t y = 0; y < region.size.y; ++y)
+    {
+        size_t first_cell = static_cast<size_t>(region.start.y + y) * grid_size.x + region.start.x;
+
+        // Decode the row straight into its output cells
+        uint32_t* row = out.data() + static_cast<size_t>(y) * region.size.x;
+        decodeBase64Bytes(view, first_cell * 4, static_cast<size_t>(region.size.x) * 4, reinterpret_cast<uint8_t*>(row));
+
+        // Gids are stored as little endian 32 bit integers
+        for (uint32_t x = 0; x < region.size.x; ++x)
+        {
+            uint8_t bytes[4] {};
+            std::memcpy(bytes, &row[x], 4);
+            row[x] = static_cast<uint32_t>(bytes[0])
+                | static_cast<uint32_t>(bytes[1]) << 8
+                | static_cast<uint32_t>(bytes[2]) << 16
+                | static_cast<uint32_t>(bytes[3]) << 24;
+        }
+    }
+}
+
+size_t tpp::detail::countCSVValues(std::string_view view)
+{
+    view = trim(view);
+    if (view.empty())
+    {
+        return 0;
+    }
+
+    // Tiled ends every row but the last with a comma
+    size_t commas = static_cast<size_t>(std::count(view.begin(), view.end(), ','));
+    return view.back() == ',' ? commas : commas + 1;
+}
+
+size_t tpp::detail::countBase64Values(std::string_view view)
+{
+    size_t chars = 0;
+    size_t padding = 0;
+    for (char c : view)
+    {
+        if (c == '=')
+            ++padding;
+        else if (!isSpace(c))
+            ++chars;
+    }
+
+    size_t groups = (chars + padding) / 4;
+    if (groups == 0)
+    {
+        return 0;
+    }
+
+    // Every gid is 4 decoded bytes
+    return (groups * 3 - std::min<size_t>(padding, 2)) / 4;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "tiledcpp/config.hpp"
+#include "tiledcpp/types/math.hpp"
 
 #include <optional>
 #include <string>
@@ -12,7 +13,13 @@ namespace tpp::detail
 TILEDCPP_API std::string getDirectory(const std::string& path);
 TILEDCPP_API std::string getExtension(const std::string& path);
 TILEDCPP_API std::string resolvePath(const std::string& base, const std::string& path);
+
+// Like resolvePath, but purely lexical: never touches the filesystem
+TILEDCPP_API std::string joinPath(const std::string& base, const std::string& path);
 TILEDCPP_API std::string getFileContents(const std::string& path);
+
+// Reads the whole file into out, reusing its capacity. Returns false if the file could not be opened
+TILEDCPP_API bool readFileContents(const std::string& path, std::string& out);
 TILEDCPP_API std::string makePreferredPath(const std::string& path);
 
 TILEDCPP_API std::optional<int> parseInt(std::string_view view);
@@ -21,4 +28,20 @@ TILEDCPP_API std::optional<uint32_t> parseIndex(std::string_view view);
 TILEDCPP_API std::optional<uint32_t> parseHex(std::string_view view);
 
 TILEDCPP_API std::vector<uint32_t> parseCSV(std::string_view view);
+
+// Parse only the values inside region out of layer data for a grid of grid_size, in row major order.
+// Rows and columns outside of the region are skipped without being parsed / decoded, CSV data written with
+// one row per line (as Tiled does) skips whole lines. The region is clamped to the grid.
+// If the data is too short or malformed, fewer values than the region size are returned
+TILEDCPP_API std::vector<uint32_t> parseCSVRegion(std::string_view view, const UVec2& grid_size, const URect& region);
+TILEDCPP_API std::vector<uint32_t> parseBase64Region(std::string_view view, const UVec2& grid_size, const URect& region);
+
+// Same as above, replacing the contents of out so that its capacity gets reused
+TILEDCPP_API void parseCSVRegion(std::string_view view, const UVec2& grid_size, const URect& region, std::vector<uint32_t>& out);
+TILEDCPP_API void parseBase64Region(std::string_view view, const UVec2& grid_size, const URect& region, std::vector<uint32_t>& out);
+
+// Number of values in layer data, found without parsing them. Lets validation detect data longer than the grid,
+// which the region parsers above never read past
+TILEDCPP_API size_t countCSVValues(std::string_view view);
+TILEDCPP_API size_t countBase64Values(std::string_view view);
 }
\ No newline at end of file
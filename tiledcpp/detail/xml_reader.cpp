@@ -0,0 +1,502 @@
+#include "tiledcpp/detail/xml_reader.hpp"
+#include "tiledcpp/detail/parse_helpers.hpp"
+
+#include <cstring>
+
+using namespace tpp::detail;
+
+namespace
+{
+
+// FNV-1a, with a per table seed so that every name lands in its own slot
+constexpr uint32_t hashName(std::string_view name, uint32_t seed)
+{
+    uint32_t hash = seed;
+    for (char c : name)
+    {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+constexpr uint32_t TABLE_BITS = 6;
+constexpr uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+
+constexpr uint32_t slotOf(std::string_view name, uint32_t seed)
+{
+    return hashName(name, seed) >> (32 - TABLE_BITS);
+}
+
+template <typename Id>
+struct NameEntry
+{
+    std::string_view name {};
+    Id id = Id::Unknown;
+};
+
+template <typename Id, size_t N>
+struct PerfectHashTable
+{
+    uint32_t seed {};
+    std::array<NameEntry<Id>, TABLE_SIZE> slots {};
+    bool collision_free = true;
+
+    constexpr PerfectHashTable(uint32_t seed, const std::array<std::string_view, N>& names)
+        : seed(seed)
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto& slot = slots[slotOf(names[i], seed)];
+            collision_free = collision_free && slot.id == Id::Unknown;
+            slot = { names[i], static_cast<Id>(i) };
+        }
+    }
+
+    constexpr Id find(std::string_view name) const
+    {
+        const auto& slot = slots[slotOf(name, seed)];
+        return slot.name == name ? slot.id : Id::Unknown;
+    }
+};
+
+// Names must follow the order of the enums
+constexpr std::array<std::string_view, static_cast<size_t>(XmlElement::COUNT)> ELEMENT_NAMES {
+    "map", "tileset", "image", "tile", "properties", "property", "animation", "frame", "layer", "data"
+};
+
+constexpr std::array<std::string_view, static_cast<size_t>(XmlAttribute::COUNT)> ATTRIBUTE_NAMES {
+    "name", "width", "height", "tilewidth", "tileheight", "tilecount", "columns", "margin", "spacing",
+    "source", "firstgid", "id", "tileid", "duration", "type", "value", "encoding", "compression"
+};
+
+// If either of these fire after adding a name, search for a new seed
+constexpr PerfectHashTable<XmlElement, ELEMENT_NAMES.size()> ELEMENT_TABLE { 2166136261u, ELEMENT_NAMES };
+static_assert(ELEMENT_TABLE.collision_free, "Element name table seed produces collisions");
+
+constexpr PerfectHashTable<XmlAttribute, ATTRIBUTE_NAMES.size()> ATTRIBUTE_TABLE { 2166136273u, ATTRIBUTE_NAMES };
+static_assert(ATTRIBUTE_TABLE.collision_free, "Attribute name table seed produces collisions");
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+bool isNameEnd(char c)
+{
+    return isWhitespace(c) || c == '/' || c == '>' || c == '=';
+}
+
+}
+
+XmlElement tpp::detail::lookupElement(std::string_view name)
+{
+    return ELEMENT_TABLE.find(name);
+}
+
+XmlAttribute tpp::detail::lookupAttribute(std::string_view name)
+{
+    return ATTRIBUTE_TABLE.find(name);
+}
+
+std::string_view tpp::detail::getElementName(XmlElement element)
+{
+    return element < XmlElement::COUNT ? ELEMENT_NAMES[static_cast<size_t>(element)] : "unknown";
+}
+
+std::string_view tpp::detail::getAttributeName(XmlAttribute attribute)
+{
+    return attribute < XmlAttribute::COUNT ? ATTRIBUTE_NAMES[static_cast<size_t>(attribute)] : "unknown";
+}
+
+namespace
+{
+
+// Appends to a char buffer, which may start at the text being decoded: the decoded text is never longer
+// than what has been read so far, so writes never overtake reads
+struct CharWriter
+{
+    void push_back(char c) { *(out++) = c; }
+    void append(std::string_view text)
+    {
+        std::memmove(out, text.data(), text.size());
+        out += text.size();
+    }
+
+    char* out {};
+};
+
+// Appends the decoded raw text to out, a string or CharWriter
+template <typename Out>
+void decodeTo(std::string_view raw, Out& out)
+{
+    auto amp = raw.find('&');
+
+    while (amp != std::string_view::npos)
+    {
+        out.append(raw.substr(0, amp));
+        raw.remove_prefix(amp);
+
+        auto semicolon = raw.find(';');
+        if (semicolon == std::string_view::npos)
+        {
+            break;
+        }
+
+        std::string_view entity = raw.substr(1, semicolon - 1);
+
+        if (entity == "lt")
+            out.push_back('<');
+        else if (entity == "gt")
+            out.push_back('>');
+        else if (entity == "amp")
+            out.push_back('&');
+        else if (entity == "quot")
+            out.push_back('"');
+        else if (entity == "apos")
+            out.push_back('\'');
+        else if (entity.size() > 1 && entity.front() == '#')
+        {
+            std::optional<uint32_t> code = entity[1] == 'x'
+                ? parseHex(entity.substr(2))
+                : parseIndex(entity.substr(1));
+
+            // Encode the code point as UTF-8
+            uint32_t c = code.value_or('?');
+            if (c < 0x80)
+            {
+                out.push_back(static_cast<char>(c));
+            }
+            else if (c < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (c >> 6)));
+                out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else if (c < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (c >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (c >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+        }
+        else
+        {
+            // Unknown entity, keep as is
+            out.append(raw.substr(0, semicolon + 1));
+        }
+
+        raw.remove_prefix(semicolon + 1);
+        amp = raw.find('&');
+    }
+
+    out.append(raw);
+}
+
+// Decodes raw into out, which is empty and already has the allocator to use
+template <typename String>
+String decodeInto(std::string_view raw, String out)
+{
+    out.reserve(raw.size());
+    decodeTo(raw, out);
+    return out;
+}
+
+}
+
+std::string tpp::detail::decodeEntities(std::string_view raw)
+{
+    return decodeInto(raw, std::string {});
+}
+
+std::pmr::string tpp::detail::decodeEntities(std::string_view raw, std::pmr::memory_resource* resource)
+{
+    return decodeInto(raw, std::pmr::string { resource });
+}
+
+size_t tpp::detail::decodeEntities(std::string_view raw, char* out)
+{
+    if (raw.find('&') == std::string_view::npos)
+    {
+        if (out != raw.data())
+        {
+            std::memmove(out, raw.data(), raw.size());
+        }
+        return raw.size();
+    }
+
+    CharWriter writer { out };
+    decodeTo(raw, writer);
+    return static_cast<size_t>(writer.out - out);
+}
+
+std::optional<int> XmlTag::getInt(XmlAttribute attribute) const
+{
+    if (!has(attribute))
+    {
+        return std::nullopt;
+    }
+    return parseInt(get(attribute));
+}
+
+XmlReader::XmlReader(std::string_view text)
+    : text(text)
+{
+}
+
+void XmlReader::skipWhitespace()
+{
+    while (pos < text.size() && isWhitespace(text[pos]))
+    {
+        ++pos;
+    }
+}
+
+bool XmlReader::skipPast(std::string_view token)
+{
+    auto found = text.find(token, pos);
+    if (found == std::string_view::npos)
+    {
+        pos = text.size();
+        error = true;
+        return false;
+    }
+
+    pos = found + token.size();
+    return true;
+}
+
+bool XmlReader::skipTagRemainder()
+{
+    while (pos < text.size())
+    {
+        char c = text[pos];
+
+        if (c == '"' || c == '\'')
+        {
+            auto close = text.find(c, pos + 1);
+            if (close == std::string_view::npos)
+            {
+                break;
+            }
+            pos = close + 1;
+        }
+        else if (c == '>')
+        {
+            ++pos;
+            return text[pos - 2] == '/';
+        }
+        else
+        {
+            ++pos;
+        }
+    }
+
+    pos = text.size();
+    error = true;
+    return true;
+}
+
+bool XmlReader::nextChild(XmlTag& tag)
+{
+    while (!error)
+    {
+        auto open = text.find('<', pos);
+        if (open == std::string_view::npos || open + 1 >= text.size())
+        {
+            // Running out of text is only fine outside of the root element
+            pos = text.size();
+            error = depth > 0;
+            return false;
+        }
+
+        pos = open + 1;
+        char first = text[pos];
+
+        if (first == '/')
+        {
+            skipPast(">");
+            depth -= depth > 0;
+            return false;
+        }
+        else if (first == '?')
+        {
+            skipPast("?>");
+            continue;
+        }
+        else if (first == '!')
+        {
+            if (text.compare(pos, 3, "!--") == 0)
+                skipPast("-->");
+            else if (text.compare(pos, 8, "![CDATA[") == 0)
+                skipPast("]]>");
+            else
+                skipTagRemainder();
+            continue;
+        }
+
+        // Start tag: dispatch the element name, then every attribute in a single pass
+
+        size_t name_start = pos;
+        while (pos < text.size() && !isNameEnd(text[pos]))
+        {
+            ++pos;
+        }
+
+        tag.element = lookupElement(text.substr(name_start, pos - name_start));
+        tag.is_empty = false;
+        tag.present = 0;
+
+        while (true)
+        {
+            skipWhitespace();
+
+            if (pos >= text.size())
+            {
+                error = true;
+                return false;
+            }
+
+            char c = text[pos];
+            if (c == '>')
+            {
+                ++pos;
+                ++depth;
+                return true;
+            }
+            else if (c == '/')
+            {
+                tag.is_empty = true;
+                skipPast(">");
+                return !error;
+            }
+
+            size_t attrib_start = pos;
+            while (pos < text.size() && !isNameEnd(text[pos]))
+            {
+                ++pos;
+            }
+            std::string_view attrib_name = text.substr(attrib_start, pos - attrib_start);
+
+            skipWhitespace();
+            if (pos >= text.size() || text[pos] != '=')
+            {
+                error = true;
+                return false;
+            }
+            ++pos;
+            skipWhitespace();
+
+            if (pos >= text.size() || (text[pos] != '"' && text[pos] != '\''))
+            {
+                error = true;
+                return false;
+            }
+
+            char quote = text[pos++];
+            auto close = text.find(quote, pos);
+            if (close == std::string_view::npos)
+            {
+                error = true;
+                return false;
+            }
+
+            auto attribute = lookupAttribute(attrib_name);
+            if (attribute != XmlAttribute::Unknown)
+            {
+                tag.present |= 1u << static_cast<uint32_t>(attribute);
+                tag.values[static_cast<size_t>(attribute)] = text.substr(pos, close - pos);
+            }
+
+            pos = close + 1;
+        }
+    }
+
+    return false;
+}
+
+void XmlReader::skip(const XmlTag& tag)
+{
+    if (tag.is_empty)
+    {
+        return;
+    }
+
+    uint32_t nested = 1;
+    while (nested > 0 && !error)
+    {
+        auto open = text.find('<', pos);
+        if (open == std::string_view::npos || open + 1 >= text.size())
+        {
+            pos = text.size();
+            error = true;
+            return;
+        }
+
+        pos = open + 1;
+        char first = text[pos];
+
+        if (first == '/')
+        {
+            skipPast(">");
+            --nested;
+        }
+        else if (first == '?')
+        {
+            skipPast("?>");
+        }
+        else if (first == '!')
+        {
+            if (text.compare(pos, 3, "!--") == 0)
+                skipPast("-->");
+            else if (text.compare(pos, 8, "![CDATA[") == 0)
+                skipPast("]]>");
+            else
+                skipTagRemainder();
+        }
+        else if (!skipTagRemainder())
+        {
+            ++nested;
+        }
+    }
+
+    depth -= depth > 0;
+}
+
+std::string_view XmlReader::readText(const XmlTag& tag)
+{
+    if (tag.is_empty)
+    {
+        return {};
+    }
+
+    size_t start = pos;
+    auto open = text.find('<', pos);
+    if (open == std::string_view::npos)
+    {
+        pos = text.size();
+        error = true;
+        return {};
+    }
+
+    std::string_view content = text.substr(start, open - start);
+
+    // Usual case: text followed by the closing tag. Otherwise fall back to skipping any nested elements
+    pos = open;
+    if (open + 1 < text.size() && text[open + 1] == '/')
+    {
+        skipPast(">");
+        depth -= depth > 0;
+    }
+    else
+    {
+        skip(tag);
+    }
+
+    return content;
+}
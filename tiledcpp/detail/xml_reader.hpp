@@ -0,0 +1,138 @@
+#pragma once
+
+#include "tiledcpp/config.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace tpp::detail
+{
+
+// Elements of the TMX / TSX schema that TiledCpp reads. Anything else is reported as Unknown
+enum class XmlElement : uint8_t
+{
+    Map,
+    TileSet,
+    Image,
+    Tile,
+    Properties,
+    Property,
+    Animation,
+    Frame,
+    Layer,
+    Data,
+
+    COUNT,
+    Unknown = COUNT
+};
+
+// Attributes of the TMX / TSX schema that TiledCpp reads. Anything else is ignored while scanning a tag
+enum class XmlAttribute : uint8_t
+{
+    Name,
+    Width,
+    Height,
+    TileWidth,
+    TileHeight,
+    TileCount,
+    Columns,
+    Margin,
+    Spacing,
+    Source,
+    FirstGid,
+    Id,
+    TileId,
+    Duration,
+    Type,
+    Value,
+    Encoding,
+    Compression,
+
+    COUNT,
+    Unknown = COUNT
+};
+
+// Perfect hash lookups of element and attribute names
+TILEDCPP_API XmlElement lookupElement(std::string_view name);
+TILEDCPP_API XmlAttribute lookupAttribute(std::string_view name);
+
+TILEDCPP_API std::string_view getElementName(XmlElement element);
+TILEDCPP_API std::string_view getAttributeName(XmlAttribute attribute);
+
+// Replaces the predefined XML entities and character references in a string
+TILEDCPP_API std::string decodeEntities(std::string_view raw);
+
+// Same as above, allocating the result from resource
+TILEDCPP_API std::pmr::string decodeEntities(std::string_view raw, std::pmr::memory_resource* resource);
+
+// Writes the decoded text to out, which needs raw.size() chars and may be raw.data() to decode in place.
+// Returns the decoded size
+TILEDCPP_API size_t decodeEntities(std::string_view raw, char* out);
+
+// A start tag read by XmlReader. Attribute values are views into the source text, with entities still encoded
+struct TILEDCPP_API XmlTag
+{
+    XmlElement element = XmlElement::Unknown;
+
+    // Self closing tags (<tag/>) have no children or text
+    bool is_empty = false;
+
+    bool has(XmlAttribute attribute) const { return present & (1u << static_cast<uint32_t>(attribute)); }
+
+    // Returns an empty view if the attribute is missing
+    std::string_view get(XmlAttribute attribute) const { return has(attribute) ? values[static_cast<size_t>(attribute)] : std::string_view {}; }
+
+    std::optional<int> getInt(XmlAttribute attribute) const;
+
+private:
+    friend class XmlReader;
+
+    static_assert(static_cast<size_t>(XmlAttribute::COUNT) <= 32, "Attribute mask does not fit in 32 bits");
+
+    uint32_t present {};
+    std::array<std::string_view, static_cast<size_t>(XmlAttribute::COUNT)> values {};
+};
+
+// Forward only reader over TMX / TSX documents. Every tag is scanned once:
+// element and attribute names are dispatched through the perfect hash tables above,
+// so there are no repeated string compares per lookup and no allocations.
+//
+// Usage follows the document structure: nextChild() returns the children of the current element one by one,
+// and every non empty child must be consumed with either a nested nextChild() loop, skip() or readText()
+class TILEDCPP_API XmlReader
+{
+public:
+    explicit XmlReader(std::string_view text);
+
+    // Reads the next child element of the current element, skipping text, comments and declarations.
+    // Returns false (and consumes the end tag) once the current element is finished
+    bool nextChild(XmlTag& tag);
+
+    // Skips all the contents of a tag returned by nextChild()
+    void skip(const XmlTag& tag);
+
+    // Returns the raw text content of a tag returned by nextChild() and moves past its end tag
+    std::string_view readText(const XmlTag& tag);
+
+    // True if the document ended unexpectedly or contained a malformed tag
+    bool hasError() const { return error; }
+
+private:
+    // Moves past the remainder of a start tag, returns true if it was self closing
+    bool skipTagRemainder();
+    bool skipPast(std::string_view token);
+    void skipWhitespace();
+
+    std::string_view text {};
+    size_t pos {};
+
+    // Number of currently open elements
+    uint32_t depth {};
+    bool error {};
+};
+
+}
@@ -0,0 +1,184 @@
+#include "tiledcpp/parallel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+
+// Threads started on the first parallel call and reused by every later one.
+// One job runs at a time: calls made while the pool is busy (from inside a task, or from another thread)
+// run on their calling thread instead of waiting, so nested calls can not deadlock
+class ThreadPool
+{
+public:
+    ThreadPool()
+    {
+        size_t worker_count = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+        workers.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; ++i)
+        {
+            workers.emplace_back([this]()
+                { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock { mutex };
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void run(size_t task_count, const std::function<void(size_t)>& task)
+    {
+        std::unique_lock<std::mutex> busy { job_mutex, std::try_to_lock };
+        if (!busy || workers.empty() || task_count <= 1)
+        {
+            for (size_t i = 0; i < task_count; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        Job job { task_count, task };
+        {
+            std::lock_guard<std::mutex> lock { mutex };
+            current = &job;
+            ++generation;
+        }
+        wake.notify_all();
+
+        job.work();
+
+        // No new worker can join once current is reset, then wait for the ones still inside the job
+        {
+            std::unique_lock<std::mutex> lock { mutex };
+            current = nullptr;
+            done.wait(lock, [&job]()
+                { return job.active_workers == 0; });
+        }
+
+        if (job.error)
+        {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct Job
+    {
+        Job(size_t task_count, const std::function<void(size_t)>& task)
+            : task_count(task_count)
+            , task(task)
+        {
+        }
+
+        // Claims tasks until none are left. The first exception is kept and stops the remaining tasks
+        void work()
+        {
+            for (size_t i = next_task++; i < task_count; i = next_task++)
+            {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock { error_mutex };
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    next_task = task_count;
+                }
+            }
+        }
+
+        size_t task_count {};
+        const std::function<void(size_t)>& task;
+        std::atomic<size_t> next_task { 0 };
+
+        std::mutex error_mutex {};
+        std::exception_ptr error {};
+
+        // Guarded by ThreadPool::mutex
+        size_t active_workers {};
+    };
+
+    void workerLoop()
+    {
+        uint64_t seen_generation = 0;
+
+        std::unique_lock<std::mutex> lock { mutex };
+        while (true)
+        {
+            wake.wait(lock, [&]()
+                { return stopping || (current != nullptr && generation != seen_generation); });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            seen_generation = generation;
+            Job& job = *current;
+            ++job.active_workers;
+
+            lock.unlock();
+            job.work();
+            lock.lock();
+
+            if (--job.active_workers == 0)
+            {
+                done.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers {};
+
+    // Held by the caller for the duration of a job
+    std::mutex job_mutex {};
+
+    std::mutex mutex {};
+    std::condition_variable wake {};
+    std::condition_variable done {};
+    Job* current {};
+    uint64_t generation {};
+    bool stopping {};
+};
+
+}
+
+tpp::Executor tpp::getThreadExecutor()
+{
+    return [](size_t task_count, const std::function<void(size_t)>& task)
+    {
+        static ThreadPool pool {};
+        pool.run(task_count, task);
+    };
+}
+
+tpp::Executor tpp::getSerialExecutor()
+{
+    return [](size_t task_count, const std::function<void(size_t)>& task)
+    {
+        for (size_t i = 0; i < task_count; ++i)
+        {
+            task(i);
+        }
+    };
+}
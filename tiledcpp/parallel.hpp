@@ -0,0 +1,213 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/tiledcpp.hpp"
+#include "tiledcpp/types/array2d.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace tpp
+{
+
+// Runs task(i) for every i in [0, task_count), possibly in parallel, and returns once all of them are done.
+// Plug in your own job system by wrapping it in an Executor. Tasks passed by TiledCpp never throw unless user callbacks do
+using Executor = std::function<void(size_t task_count, const std::function<void(size_t)>& task)>;
+
+// Runs the tasks on a pool of std::threads started on first use, one per hardware thread (the calling thread included).
+// If a task throws, the tasks not started yet are skipped and the first exception is rethrown on the calling thread
+// once every thread has left the call. Calls made while the pool is busy, from inside a task or from another thread,
+// run on their calling thread. This is the default of the functions below, engines with a job system should pass their own
+TILEDCPP_API Executor getThreadExecutor();
+
+// Runs all the tasks on the calling thread, in order
+TILEDCPP_API Executor getSerialExecutor();
+
+namespace detail
+{
+
+// Rows [0, rows) split in bands of whole rows with at least MIN_BAND_CELLS cells each
+struct RowBands
+{
+    static constexpr size_t MIN_BAND_CELLS = 1 << 14;
+
+    RowBands(uint32_t rows, uint32_t width)
+        : rows(rows)
+        , band_rows(rows == 0 || width == 0 ? 1 : static_cast<uint32_t>(std::min<size_t>(rows, (MIN_BAND_CELLS + width - 1) / width)))
+        , count(width == 0 ? 0 : (rows + band_rows - 1) / band_rows)
+    {
+    }
+
+    // Runs fn(band, y_begin, y_end) for every band
+    template <typename F>
+    void run(const Executor& executor, F&& fn) const
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        executor(count, [&](size_t band)
+            {
+                uint32_t y_begin = static_cast<uint32_t>(band * band_rows);
+                fn(band, y_begin, std::min(rows, y_begin + band_rows)); });
+    }
+
+    uint32_t rows {};
+    uint32_t band_rows {};
+    size_t count {};
+};
+
+// Calls fn(x, y, tile) for the rows [y_begin, y_end) of a layer, decoding a row at a time with copyRow
+template <typename F>
+void forLayerRows(const TileLayer& layer, uint32_t y_begin, uint32_t y_end, F&& fn)
+{
+    std::vector<TileID> row(layer.size().x);
+
+    for (uint32_t y = y_begin; y < y_end; ++y)
+    {
+        layer.copyRow(y, row.data());
+
+        for (uint32_t x = 0; x < row.size(); ++x)
+        {
+            fn(x, y, row[x]);
+        }
+    }
+}
+
+}
+
+// Calls fn(x, y, value) for every element of the array, with the rows split in bands over the executor.
+// fn may modify the value, but must not touch other elements
+template <typename T, typename Layout, typename F>
+void parallelForRows(Array2D<T, Layout>& array, F&& fn, const Executor& executor = getThreadExecutor())
+{
+    detail::RowBands(array.size().y, array.size().x).run(executor, [&](size_t, uint32_t y_begin, uint32_t y_end)
+        {
+            for (uint32_t y = y_begin; y < y_end; ++y)
+            {
+                for (uint32_t x = 0; x < array.size().x; ++x)
+                {
+                    fn(x, y, array(x, y));
+                }
+            } });
+}
+
+template <typename T, typename Layout, typename F>
+void parallelForRows(const Array2D<T, Layout>& array, F&& fn, const Executor& executor = getThreadExecutor())
+{
+    detail::RowBands(array.size().y, array.size().x).run(executor, [&](size_t, uint32_t y_begin, uint32_t y_end)
+        {
+            for (uint32_t y = y_begin; y < y_end; ++y)
+            {
+                for (uint32_t x = 0; x < array.size().x; ++x)
+                {
+                    fn(x, y, array(x, y));
+                }
+            } });
+}
+
+// Same as above for a tile layer in any LayerStorage. fn gets every tile by value, including empty ones
+template <typename F>
+void parallelForRows(const TileLayer& layer, F&& fn, const Executor& executor = getThreadExecutor())
+{
+    detail::RowBands(layer.size().y, layer.size().x).run(executor, [&](size_t, uint32_t y_begin, uint32_t y_end)
+        { detail::forLayerRows(layer, y_begin, y_end, fn); });
+}
+
+// Returns a new array (with the same size and layout) holding fn(x, y, value) for every element
+template <typename T, typename Layout, typename F>
+auto transform(const Array2D<T, Layout>& array, F&& fn, const Executor& executor = getThreadExecutor())
+{
+    using U = std::decay_t<std::invoke_result_t<F&, uint32_t, uint32_t, const T&>>;
+
+    Array2D<U, Layout> out(array.size().x, array.size().y);
+
+    detail::RowBands(array.size().y, array.size().x).run(executor, [&](size_t, uint32_t y_begin, uint32_t y_end)
+        {
+            for (uint32_t y = y_begin; y < y_end; ++y)
+            {
+                for (uint32_t x = 0; x < array.size().x; ++x)
+                {
+                    out(x, y) = fn(x, y, array(x, y));
+                }
+            } });
+
+    return out;
+}
+
+// Returns a dense array the size of the layer holding fn(x, y, tile) for every tile
+template <typename F>
+auto transform(const TileLayer& layer, F&& fn, const Executor& executor = getThreadExecutor())
+{
+    using U = std::decay_t<std::invoke_result_t<F&, uint32_t, uint32_t, TileID>>;
+
+    Array2D<U> out(layer.size().x, layer.size().y);
+
+    detail::RowBands(layer.size().y, layer.size().x).run(executor, [&](size_t, uint32_t y_begin, uint32_t y_end)
+        {
+            detail::forLayerRows(layer, y_begin, y_end, [&](uint32_t x, uint32_t y, TileID tile)
+                { out(x, y) = fn(x, y, tile); }); });
+
+    return out;
+}
+
+// Folds every element into an accumulator: every row band starts from init and folds its elements
+// with fn(accumulator, x, y, value), then the band results are merged in row order with combine(a, b).
+// The result only matches a serial fold if init is neutral for combine
+template <typename T, typename Layout, typename Acc, typename F, typename Combine>
+Acc reduce(const Array2D<T, Layout>& array, Acc init, F&& fn, Combine&& combine, const Executor& executor = getThreadExecutor())
+{
+    detail::RowBands bands(array.size().y, array.size().x);
+
+    // One separate object per band, so that bands never write to shared memory (even with Acc = bool)
+    std::vector<std::optional<Acc>> band_results(bands.count);
+
+    bands.run(executor, [&](size_t band, uint32_t y_begin, uint32_t y_end)
+        {
+            Acc acc = init;
+            for (uint32_t y = y_begin; y < y_end; ++y)
+            {
+                for (uint32_t x = 0; x < array.size().x; ++x)
+                {
+                    acc = fn(std::move(acc), x, y, array(x, y));
+                }
+            }
+            band_results[band] = std::move(acc); });
+
+    Acc out = std::move(init);
+    for (auto& result : band_results)
+    {
+        out = combine(std::move(out), std::move(*result));
+    }
+    return out;
+}
+
+// Same as above for a tile layer in any LayerStorage
+template <typename Acc, typename F, typename Combine>
+Acc reduce(const TileLayer& layer, Acc init, F&& fn, Combine&& combine, const Executor& executor = getThreadExecutor())
+{
+    detail::RowBands bands(layer.size().y, layer.size().x);
+
+    std::vector<std::optional<Acc>> band_results(bands.count);
+
+    bands.run(executor, [&](size_t band, uint32_t y_begin, uint32_t y_end)
+        {
+            Acc acc = init;
+            detail::forLayerRows(layer, y_begin, y_end, [&](uint32_t x, uint32_t y, TileID tile)
+                { acc = fn(std::move(acc), x, y, tile); });
+            band_results[band] = std::move(acc); });
+
+    Acc out = std::move(init);
+    for (auto& result : band_results)
+    {
+        out = combine(std::move(out), std::move(*result));
+    }
+    return out;
+}
+
+}
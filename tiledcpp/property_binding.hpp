@@ -0,0 +1,104 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/tiledcpp.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace tpp
+{
+
+// One struct member filled from the custom property with the given key
+template <typename S, typename T>
+struct PropertyField
+{
+    Key key;
+    T S::*member;
+};
+
+template <typename S, typename T>
+constexpr PropertyField<S, T> bindField(std::string_view key, T S::*member)
+{
+    static_assert(std::is_same_v<T, bool> || std::is_same_v<T, int> || std::is_same_v<T, float>
+            || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> || std::is_same_v<T, Pixel>,
+        "Bound fields must be bool, int, float, std::string, std::string_view or tpp::Pixel");
+
+    return PropertyField<S, T> { Key(key), member };
+}
+
+// Describes the custom properties of a user struct, by specializing it with a tuple of fields:
+//
+//   struct TileInfo { float speed = 1.0f; int hp = 0; bool walkable = true; };
+//
+//   template <>
+//   struct tpp::PropertyBinding<TileInfo>
+//   {
+//       static constexpr auto fields = std::make_tuple(
+//           tpp::bindField("speed", &TileInfo::speed),
+//           tpp::bindField("hp", &TileInfo::hp),
+//           tpp::bindField("walkable", &TileInfo::walkable));
+//   };
+//
+// The keys are hashed at compile time
+template <typename S>
+struct PropertyBinding;
+
+namespace detail
+{
+
+template <typename S, typename T>
+void readField(const PropertyMap& properties, const PropertyField<S, T>& field, S& out)
+{
+    if (auto value = properties.get<T>(field.key))
+    {
+        out.*field.member = std::move(*value);
+    }
+}
+
+}
+
+// Sets every bound field of out that has a property of the same name and type in properties,
+// other fields keep their value. std::string_view fields point into the property map
+template <typename S>
+void bindProperties(const PropertyMap& properties, S& out)
+{
+    std::apply([&](const auto&... fields)
+        { (detail::readField(properties, fields, out), ...); },
+        PropertyBinding<S>::fields);
+}
+
+// Returns defaults with the bound fields overwritten by properties, if any
+template <typename S>
+S bindProperties(const PropertyMap* properties, const S& defaults = S {})
+{
+    S out = defaults;
+    if (properties != nullptr)
+    {
+        bindProperties(*properties, out);
+    }
+    return out;
+}
+
+// Decodes the properties of every tile of the tileset at once, into a dense array indexed by tile id.
+// Tiles without properties get defaults. Decode once after loading, then read plain struct fields in hot paths
+template <typename S>
+std::vector<S> bindTileProperties(const TileSet& tileset, const S& defaults = S {})
+{
+    std::vector<S> out(tileset.getTileCount(), defaults);
+
+    for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+    {
+        if (const PropertyMap* properties = tileset.getTileProperties(tile))
+        {
+            bindProperties(*properties, out[tile]);
+        }
+    }
+    return out;
+}
+
+}
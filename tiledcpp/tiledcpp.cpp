@@ -1,296 +1,1169 @@
 #include "tiledcpp/tiledcpp.hpp"
 #include "tiledcpp/detail/parse_helpers.hpp"
+#include "tiledcpp/detail/xml_reader.hpp"
 
-#include <RapidXML/rapidxml.hpp>
 #include <algorithm>
-
+#include <fstream>
+#include <memory_resource>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace tpp;
+using detail::XmlAttribute;
+using detail::XmlElement;
+
+struct tpp::detail::LoadBuffers
+{
+    // File contents. A map keeps its text alive while its tilesets load
+    std::string map_text {};
+    std::string tileset_text {};
+
+    // Gids of the layer being loaded
+    std::vector<uint32_t> gids {};
+
+    // chooseLayerStorage() statistics
+    std::vector<bool> used_chunks {};
+
+    // Hash nodes are returned to the pool when the tables are cleared, and reused on the next layer or load
+    std::pmr::unsynchronized_pool_resource node_pool {};
+    std::pmr::unordered_set<uint32_t> distinct_gids { &node_pool };
+    std::pmr::unordered_map<uint32_t, uint32_t> compact_lookup { &node_pool };
+};
 
 // Helpers
 
-std::optional<int> getIntAttribute(const rapidxml::xml_node<char>* node, const char* name)
+namespace
 {
-    if (auto attrib = node->first_attribute(name))
+
+// Collects the first error found while loading with ValidationMode::Validate.
+// In trusted mode every check is skipped and missing attributes read as 0
+class Validator
+{
+public:
+    Validator(const LoadOptions& options, const char* context, const std::string& path)
+        : enabled(options.validation == ValidationMode::Validate)
+        , context(context)
+        , path(path)
     {
-        return detail::parseInt(attrib->value());
     }
-    return std::nullopt;
-}
 
-std::unique_ptr<PropertyMap> tryGetProperties(const rapidxml::xml_node<char>* node)
-{
-    if (auto* props = node->first_node("properties"))
+    bool isEnabled() const { return enabled; }
+    bool failed() const { return error.has_value(); }
+    Error takeError() { return std::move(error.value()); }
+
+    void check(bool condition, const char* message)
     {
-        auto result = PropertyMap::fromNode(props);
-        if (result)
+        if (enabled && !condition && !error)
         {
-            return std::make_unique<PropertyMap>(std::move(result.value()));
+            error = Error { std::string(context) + " " + message + ": " + path };
         }
     }
+
+    // Records an error found by another parser, e.g. PropertyMap::fromReader
+    void fail(const std::string& message)
+    {
+        if (enabled && !error)
+        {
+            error = Error { std::string(context) + " " + message + ": " + path };
+        }
+    }
+
+    uint32_t requireUInt(const detail::XmlTag& tag, XmlAttribute attribute)
+    {
+        auto value = tag.getInt(attribute);
+
+        if (enabled && (!value || *value < 0) && !error)
+        {
+            error = Error { std::string(context) + " missing or invalid attribute '"
+                + std::string(detail::getAttributeName(attribute)) + "' in <"
+                + std::string(detail::getElementName(tag.element)) + ">: " + path };
+        }
+
+        return static_cast<uint32_t>(value.value_or(0));
+    }
+
+    std::string_view requireString(const detail::XmlTag& tag, XmlAttribute attribute)
+    {
+        if (enabled && !tag.has(attribute) && !error)
+        {
+            error = Error { std::string(context) + " missing attribute '"
+                + std::string(detail::getAttributeName(attribute)) + "' in <"
+                + std::string(detail::getElementName(tag.element)) + ">: " + path };
+        }
+
+        return tag.get(attribute);
+    }
+
+private:
+    bool enabled {};
+    const char* context {};
+    const std::string& path;
+    std::optional<Error> error {};
+};
+
+std::pmr::memory_resource* getResource(const LoadOptions& options)
+{
+    return options.memory_resource ? options.memory_resource : std::pmr::get_default_resource();
+}
+
+// Malformed properties are reported through validator, trusted loads skip them
+ResourcePtr<PropertyMap> tryGetProperties(detail::XmlReader& reader, const detail::XmlTag& properties_tag, Validator& validator, std::pmr::memory_resource* resource, StringStore* retained = nullptr)
+{
+    auto result = PropertyMap::fromReader(reader, properties_tag, resource, retained, validator.isEnabled());
+    if (result)
+    {
+        return allocateUnique<PropertyMap>(resource, std::move(result.value()), resource);
+    }
+    validator.fail(result.error().message);
     return nullptr;
 }
 
-TileID::TileID(uint32_t tileset, uint32_t flag_id)
-    : tileset(tileset)
-    , flag_id(flag_id)
+// Reads the <map> attributes. Shared by TileMap::load and TileMap::probe, so that both agree on a valid header
+void readMapAttributes(Validator& validator, const detail::XmlTag& map_tag, UVec2& map_size, UVec2& map_tile_size)
 {
+    map_size.x = validator.requireUInt(map_tag, XmlAttribute::Width);
+    map_size.y = validator.requireUInt(map_tag, XmlAttribute::Height);
+    map_tile_size.x = validator.requireUInt(map_tag, XmlAttribute::TileWidth);
+    map_tile_size.y = validator.requireUInt(map_tag, XmlAttribute::TileHeight);
 }
 
-uint32_t TileID::getId() const
+// Reads and checks a <tileset> reference of a map. previous_first_gid is the first gid of the tileset before it, 0 if none
+TileSetInfo readTileSetReference(Validator& validator, const detail::XmlTag& tileset_tag, const std::string& base, uint32_t previous_first_gid)
 {
-    return flag_id;
+    TileSetInfo out {};
+
+    std::string path = detail::decodeEntities(validator.requireString(tileset_tag, XmlAttribute::Source));
+    out.first_gid = validator.requireUInt(tileset_tag, XmlAttribute::FirstGid);
+
+    validator.check(out.first_gid > 0, "tileset firstgid must be at least 1");
+    validator.check(out.first_gid > previous_first_gid, "tilesets are not sorted by firstgid");
+
+    out.source = validator.isEnabled()
+        ? detail::resolvePath(base, path)
+        : detail::joinPath(base, path);
+
+    return out;
 }
 
-uint32_t TileID::getTileset() const
+// Appends the frames of the animation to frames
+void parseAnimation(detail::XmlReader& reader, const detail::XmlTag& animation_tag, Validator& validator, std::pmr::vector<KeyFrame>& frames)
 {
-    return tileset;
+    if (animation_tag.is_empty)
+    {
+        return;
+    }
+
+    detail::XmlTag frame_tag {};
+    while (reader.nextChild(frame_tag))
+    {
+        if (frame_tag.element == XmlElement::Frame)
+        {
+            KeyFrame frame {};
+
+            frame.tile_id = validator.requireUInt(frame_tag, XmlAttribute::TileId);
+            frame.duration_ms = validator.requireUInt(frame_tag, XmlAttribute::Duration);
+
+            frames.emplace_back(frame);
+        }
+
+        reader.skip(frame_tag);
+    }
+}
+
+// Slot of tile in a per tile index, growing the index on first use.
+// Tile ids past tile_count are only possible with ValidationMode::Trusted
+uint32_t& indexSlot(std::pmr::vector<uint32_t>& index, uint32_t tile, uint32_t tile_count, uint32_t none)
+{
+    if (tile >= index.size())
+    {
+        index.resize(std::max(tile_count, tile + 1), none);
+    }
+    return index[tile];
 }
 
-bool TileID::isFlippedHorizontally() const
+// Picks the layer container using the least memory, unless dense storage is within a factor 2 of it
+// compact_table_size is the number of tiles already in the map's Compact16 table
+LayerStorage chooseLayerStorage(const UVec2& size, const std::vector<uint32_t>& gids, size_t compact_table_size, detail::LoadBuffers& buffers)
 {
-    return flag_id & TileFlags::FLIPPED_HORIZONTALLY_FLAG;
+    constexpr uint32_t CHUNK_SIZE = 16;
+
+    UVec2 chunk_grid { (size.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (size.y + CHUNK_SIZE - 1) / CHUNK_SIZE };
+
+    auto& used_chunks = buffers.used_chunks;
+    used_chunks.assign(static_cast<size_t>(chunk_grid.x) * chunk_grid.y, false);
+
+    auto& distinct_gids = buffers.distinct_gids;
+    distinct_gids.clear();
+
+    size_t run_count = 0;
+    size_t chunk_count = 0;
+
+    for (uint32_t y = 0; y < size.y; ++y)
+    {
+        const uint32_t* row = gids.data() + static_cast<size_t>(y) * size.x;
+
+        for (uint32_t x = 0; x < size.x; ++x)
+        {
+            // New runs are the only places where a new gid can show up
+            if (x == 0 || row[x] != row[x - 1])
+            {
+                ++run_count;
+                distinct_gids.insert(row[x]);
+            }
+
+            size_t chunk = static_cast<size_t>(y / CHUNK_SIZE) * chunk_grid.x + x / CHUNK_SIZE;
+            if (row[x] != 0 && !used_chunks[chunk])
+            {
+                used_chunks[chunk] = true;
+                ++chunk_count;
+            }
+        }
+    }
+
+    size_t dense_bytes = gids.size() * sizeof(TileID);
+    size_t run_length_bytes = run_count * sizeof(RunLengthGrid<TileID>::Run) + (static_cast<size_t>(size.y) + 1) * sizeof(size_t);
+    size_t sparse_bytes = chunk_count * CHUNK_SIZE * CHUNK_SIZE * sizeof(TileID) + used_chunks.size() * sizeof(uint32_t);
+
+    size_t paletted_bytes = distinct_gids.size() <= PalettedGrid<TileID>::MAX_PALETTE_SIZE
+        ? PalettedGrid<TileID>::estimateBytes(size, distinct_gids.size())
+        : dense_bytes;
+
+    // Upper bound, some of the gids can already be in the table
+    size_t compact_bytes = compact_table_size + distinct_gids.size() <= UINT16_MAX + 1
+        ? gids.size() * sizeof(uint16_t)
+        : dense_bytes;
+
+    // Sparse, paletted and compact access is O(1), run length storage has to be much smaller to win
+    LayerStorage best = LayerStorage::Sparse;
+    size_t best_bytes = sparse_bytes;
+
+    if (compact_bytes < best_bytes)
+    {
+        best = LayerStorage::Compact16;
+        best_bytes = compact_bytes;
+    }
+    if (paletted_bytes < best_bytes)
+    {
+        best = LayerStorage::Paletted;
+        best_bytes = paletted_bytes;
+    }
+    if (run_length_bytes * 2 < best_bytes)
+    {
+        best = LayerStorage::RunLength;
+        best_bytes = run_length_bytes;
+    }
+
+    return best_bytes * 2 <= dense_bytes ? best : LayerStorage::Dense;
 }
 
-bool TileID::isFlippedVertically() const
+Array2D<TileID> makeDenseTiles(const UVec2& size, const std::vector<uint32_t>& gids)
 {
-    return flag_id & TileFlags::FLIPPED_VERTICALLY_FLAG;
+    Array2D<TileID> out(size.x, size.y);
+    std::transform(gids.begin(), gids.end(), out.data(), [](uint32_t gid)
+        { return TileID { gid }; });
+    return out;
 }
 
-TileID calculateTileID(const std::vector<uint32_t>& first_gids, uint32_t global_gid)
+// Table of distinct tiles shared by the Compact16 layers of a map
+struct CompactTable
 {
-    if (first_gids.empty() || global_gid == 0)
+    explicit CompactTable(std::pmr::unordered_map<uint32_t, uint32_t>& lookup)
+        : lookup(lookup)
     {
-        return TileID();
+        // Index 0 is the empty tile, so new cells start empty
+        tiles->emplace_back(0);
+        lookup.clear();
+        lookup.emplace(0, 0);
     }
 
-    for (uint32_t i = first_gids.size() - 1; i >= 0; --i)
+    // Stores the layer as a CompactTileGrid, returns false if the table runs out of indices
+    bool encode(const UVec2& size, const std::vector<uint32_t>& gids, TileLayer& layer)
     {
-        if (first_gids.at(i) <= global_gid)
+        Array2D<uint16_t> indices(size.x, size.y);
+        uint16_t* out = indices.data();
+
+        for (size_t i = 0; i < gids.size(); ++i)
         {
-            return TileID(i, global_gid - first_gids.at(i));
+            auto [it, inserted] = lookup.try_emplace(gids[i], static_cast<uint32_t>(tiles->size()));
+            if (inserted)
+            {
+                if (tiles->size() > UINT16_MAX)
+                {
+                    lookup.erase(it);
+                    return false;
+                }
+                tiles->emplace_back(gids[i]);
+            }
+            out[i] = static_cast<uint16_t>(it->second);
         }
+
+        layer.tiles = CompactTileGrid { std::move(indices), tiles };
+        return true;
     }
 
-    return TileID();
+    std::shared_ptr<std::vector<TileID>> tiles = std::make_shared<std::vector<TileID>>();
+
+    // Tile to index, borrowed from the load buffers
+    std::pmr::unordered_map<uint32_t, uint32_t>& lookup;
+};
+
 }
 
 // Implementation
 
-Result<TileSet> TileSet::fromTSX(const std::string& path, [[maybe_unused]] std::ostream* warnings)
+Result<TileSet> TileSet::fromTSX(const std::string& path, std::ostream* warnings)
+{
+    return fromTSX(path, LoadOptions {}, warnings);
+}
+
+TileSet::TileSet(std::pmr::memory_resource* resource)
+    : metadata(allocateUnique<TileMetadata>(resource, resource))
+{
+}
+
+Result<TileSet> TileSet::fromTSX(const std::string& path, const LoadOptions& options, std::ostream* warnings)
+{
+    detail::LoadBuffers buffers {};
+    return load(path, options, buffers, warnings);
+}
+
+Result<TileSet> TileSet::load(const std::string& path, const LoadOptions& options, detail::LoadBuffers& buffers, [[maybe_unused]] std::ostream* warnings)
 {
-    TileSet out {};
+    auto* resource = getResource(options);
+
+    TileSet out { resource };
+    Validator validator { options, "[Tileset]", path };
 
     auto base_path = detail::getDirectory(path);
-    auto extension = detail::getExtension(path);
 
-    if (extension != ".tsx" && extension != ".xml")
+    if (validator.isEnabled())
     {
-        Error err { std::string("[Tileset] is not a .tsx or .xml file: ") + path };
-        return tl::make_unexpected(err);
+        auto extension = detail::getExtension(path);
+
+        if (extension != ".tsx" && extension != ".xml")
+        {
+            Error err { std::string("[Tileset] is not a .tsx or .xml file: ") + path };
+            return tl::make_unexpected(err);
+        }
     }
 
-    std::string text = detail::getFileContents(path);
-    if (text.empty())
+    std::string& text = buffers.tileset_text;
+    if (!detail::readFileContents(path, text) || text.empty())
     {
         Error err { std::string("[Tileset] file not found or unable to open: ") + path };
         return tl::make_unexpected(err);
     }
 
-    rapidxml::xml_document<char> document {};
-    document.parse<0>(text.data());
+    // Retained text moves to the tileset, string properties then point into it
+    if (options.retain_source)
+    {
+        out.strings = allocateUnique<StringStore>(resource, resource);
+    }
+
+    StringStore* retained = out.strings.get();
+    std::string_view source = retained ? retained->retainSource(std::move(text)) : std::string_view(text);
+
+    detail::XmlReader reader { source };
+    detail::XmlTag set_tag {};
 
     std::string source_image_path {};
+    UVec2 source_image_size {};
+    bool found_tileset = false;
 
-    if (auto set_node = document.first_node("tileset"))
+    auto& metadata = *out.metadata;
+
+    // First frame and frame count of every animation
+    std::vector<std::pair<size_t, size_t>> animation_frame_ranges {};
+
+    while (reader.nextChild(set_tag))
     {
-        out.tile_size.x = getIntAttribute(set_node, "tilewidth").value_or(0);
-        out.tile_size.y = getIntAttribute(set_node, "tileheight").value_or(0);
-        out.tile_count = getIntAttribute(set_node, "tilecount").value_or(0);
-        out.tile_stride = getIntAttribute(set_node, "columns").value_or(0);
-        out.margin = getIntAttribute(set_node, "margin").value_or(0);
-        out.spacing = getIntAttribute(set_node, "spacing").value_or(0);
+        if (set_tag.element != XmlElement::TileSet)
+        {
+            reader.skip(set_tag);
+            continue;
+        }
 
-        out.name = set_node->first_attribute("name")->value();
-        source_image_path = set_node->first_node("image")->first_attribute("source")->value();
+        found_tileset = true;
 
-        // Custom Props
+        out.tile_size.x = validator.requireUInt(set_tag, XmlAttribute::TileWidth);
+        out.tile_size.y = validator.requireUInt(set_tag, XmlAttribute::TileHeight);
+        out.tile_count = validator.requireUInt(set_tag, XmlAttribute::TileCount);
+        out.tile_stride = validator.requireUInt(set_tag, XmlAttribute::Columns);
+        // Negative values would wrap the tile rects, trusted loads read them as 0
+        int margin = set_tag.getInt(XmlAttribute::Margin).value_or(0);
+        int spacing = set_tag.getInt(XmlAttribute::Spacing).value_or(0);
+        validator.check(margin >= 0, "tileset margin is negative");
+        validator.check(spacing >= 0, "tileset spacing is negative");
+        out.margin = static_cast<uint32_t>(std::max(margin, 0));
+        out.spacing = static_cast<uint32_t>(std::max(spacing, 0));
 
-        out.custom_properties = tryGetProperties(set_node);
+        validator.check(out.tile_stride > 0 || out.tile_count == 0, "tileset has tiles but zero columns");
 
-        // Iterate all tile properties
+        // The tile count sizes the tile tables, so it is bounded by the gid range even when trusted
+        if (out.tile_count > TileID::MAX_GID)
+        {
+            Error err { std::string("[Tileset] tile count out of range: ") + path };
+            return tl::make_unexpected(err);
+        }
 
-        for (auto tile_node = set_node->first_node("tile"); tile_node != nullptr; tile_node = tile_node->next_sibling("tile"))
+        out.name = detail::decodeEntities(set_tag.get(XmlAttribute::Name));
+
+        if (set_tag.is_empty)
         {
-            auto tile_id = detail::parseInt(tile_node->first_attribute("id")->value()).value();
+            continue;
+        }
 
-            if (auto properties = tile_node->first_node("properties"))
+        detail::XmlTag child {};
+        while (reader.nextChild(child))
+        {
+            switch (child.element)
             {
-                PropertyMap map = PropertyMap::fromNode(properties).value();
-                out.tile_properties.emplace(tile_id, std::move(map));
+            case XmlElement::Image:
+            {
+                source_image_path = detail::decodeEntities(validator.requireString(child, XmlAttribute::Source));
+                source_image_size.x = child.getInt(XmlAttribute::Width).value_or(0);
+                source_image_size.y = child.getInt(XmlAttribute::Height).value_or(0);
+                reader.skip(child);
+                break;
             }
-
-            // Animations
-            if (auto animation_info = tile_node->first_node("animation"))
+            case XmlElement::Properties:
             {
-                Animation animation {};
+                // Custom Props
+                if (options.load_properties)
+                    out.custom_properties = tryGetProperties(reader, child, validator, resource, retained);
+                else
+                    reader.skip(child);
+                break;
+            }
+            case XmlElement::Tile:
+            {
+                // Iterate all tile properties
+                auto tile_id = validator.requireUInt(child, XmlAttribute::Id);
+                validator.check(tile_id < out.tile_count, "tile id out of range");
 
-                auto frame_node = animation_info->first_node("frame");
-                while (frame_node != nullptr)
+                // Tile ids size the metadata indices, out of range tiles are never read
+                if (child.is_empty || tile_id >= out.tile_count)
                 {
-                    KeyFrame frame {};
-
-                    frame.tile_id = detail::parseInt(frame_node->first_attribute("tileid")->value()).value();
-                    frame.duration_ms = detail::parseInt(frame_node->first_attribute("duration")->value()).value();
-
-                    animation.frames.emplace_back(frame);
-                    frame_node = frame_node->next_sibling("frame");
+                    reader.skip(child);
+                    break;
                 }
 
-                out.tile_animations.emplace(tile_id, std::move(animation));
+                detail::XmlTag tile_child {};
+                while (reader.nextChild(tile_child))
+                {
+                    if (tile_child.element == XmlElement::Properties && options.load_properties)
+                    {
+                        // The first <properties> of a tile wins
+                        uint32_t& slot = indexSlot(metadata.property_index, tile_id, out.tile_count, NO_METADATA);
+                        if (slot == NO_METADATA)
+                        {
+                            auto properties = PropertyMap::fromReader(reader, tile_child, resource, retained, validator.isEnabled());
+                            if (!properties)
+                            {
+                                validator.fail(properties.error().message);
+                                properties = PropertyMap { resource };
+                            }
+
+                            slot = static_cast<uint32_t>(metadata.properties.size());
+                            metadata.properties.emplace_back(std::move(properties.value()));
+                        }
+                        else
+                        {
+                            reader.skip(tile_child);
+                        }
+                    }
+                    else if (tile_child.element == XmlElement::Animation && options.load_animations)
+                    {
+                        uint32_t& slot = indexSlot(metadata.animation_index, tile_id, out.tile_count, NO_METADATA);
+                        if (slot == NO_METADATA)
+                        {
+                            // Frames are appended to the shared array, the spans are set once it stops growing
+                            slot = static_cast<uint32_t>(animation_frame_ranges.size());
+                            size_t first_frame = metadata.frames.size();
+                            parseAnimation(reader, tile_child, validator, metadata.frames);
+                            animation_frame_ranges.emplace_back(first_frame, metadata.frames.size() - first_frame);
+                        }
+                        else
+                        {
+                            reader.skip(tile_child);
+                        }
+                    }
+                    else
+                    {
+                        reader.skip(tile_child);
+                    }
+                }
+                break;
+            }
+            default:
+                reader.skip(child);
+                break;
             }
         }
     }
 
-    auto image_path = detail::resolvePath(base_path, source_image_path);
-    auto image_result = Image::fromPath(image_path);
+    metadata.animations.reserve(animation_frame_ranges.size());
+    for (auto [first_frame, frame_count] : animation_frame_ranges)
+    {
+        metadata.animations.push_back(Animation { Span<const KeyFrame>(metadata.frames.data() + first_frame, frame_count) });
+    }
+
+    if (validator.isEnabled())
+    {
+        validator.check(!reader.hasError(), "malformed XML");
+        validator.check(found_tileset, "no <tileset> element found");
+        validator.check(!options.load_images || !source_image_path.empty(), "no <image> element found");
+
+        if (validator.failed())
+        {
+            return tl::make_unexpected(validator.takeError());
+        }
+    }
 
-    if (image_result)
+    if (!options.load_images)
     {
-        out.image = std::move(image_result.value());
+        out.image = Image::fromSize(source_image_size);
     }
     else
     {
-        return tl::make_unexpected(image_result.error());
+        auto image_path = validator.isEnabled()
+            ? detail::resolvePath(base_path, source_image_path)
+            : detail::joinPath(base_path, source_image_path);
+        auto image_result = Image::fromPath(image_path);
+
+        if (image_result)
+        {
+            out.image = std::move(image_result.value());
+        }
+        else
+        {
+            return tl::make_unexpected(image_result.error());
+        }
     }
 
+    out.buildTileTables(options);
     return out;
 }
 
+void TileSet::buildTileTables(const LoadOptions& options)
+{
+    tile_rects.resize(tile_count);
+    tile_uvs.assign(tile_count, UVRect {});
+
+    UVec2 image_size = image.getSize();
+    float inset = options.inset_uvs ? 0.5f : 0.0f;
+
+    // Tilesets without columns (image collections, or bad data) have no grid to place tiles in
+    if (tile_stride == 0)
+    {
+        tile_rects.assign(tile_count, URect {});
+        tile_uv_quads.clear();
+        return;
+    }
+
+    for (uint32_t index = 0; index < tile_count; ++index)
+    {
+        uint32_t column = index % tile_stride;
+        uint32_t row = index / tile_stride;
+
+        URect& rect = tile_rects[index];
+        rect.size = tile_size;
+        rect.start.x = column * (tile_size.x + spacing) + margin;
+        rect.start.y = row * (tile_size.y + spacing) + margin;
+
+        if (image_size.x > 0 && image_size.y > 0)
+        {
+            UVRect& uvs = tile_uvs[index];
+            uvs.u0 = (float(rect.start.x) + inset) / float(image_size.x);
+            uvs.v0 = (float(rect.start.y) + inset) / float(image_size.y);
+            uvs.u1 = (float(rect.start.x + rect.size.x) - inset) / float(image_size.x);
+            uvs.v1 = (float(rect.start.y + rect.size.y) - inset) / float(image_size.y);
+        }
+    }
+
+    if (options.orientation_uvs)
+    {
+        tile_uv_quads.resize(size_t(tile_count) * TileID::ORIENTATION_COUNT);
+
+        for (uint32_t index = 0; index < tile_count; ++index)
+        {
+            for (uint32_t orientation = 0; orientation < TileID::ORIENTATION_COUNT; ++orientation)
+            {
+                tile_uv_quads[index * TileID::ORIENTATION_COUNT + orientation] = orientUVs(tile_uvs[index], orientation);
+            }
+        }
+    }
+}
+
 std::optional<URect> TileSet::getTileRect(uint32_t index) const
 {
-    if (index >= tile_count)
+    if (index >= tile_rects.size())
         return std::nullopt;
 
-    uint32_t column = index % tile_stride;
-    uint32_t row = index / tile_stride;
-
-    URect out {};
-    out.size = tile_size;
+    return tile_rects[index];
+}
 
-    out.start.x = column * (tile_size.x + spacing) + margin;
-    out.start.y = row * (tile_size.y + spacing) + margin;
+void TileSet::getTileRects(Span<const uint32_t> tile_ids, URect* out) const
+{
+    for (size_t i = 0; i < tile_ids.size(); ++i)
+    {
+        out[i] = tile_ids[i] < tile_rects.size() ? tile_rects[tile_ids[i]] : URect {};
+    }
+}
 
-    return out;
+void TileSet::getTileUVs(Span<const uint32_t> tile_ids, UVRect* out) const
+{
+    for (size_t i = 0; i < tile_ids.size(); ++i)
+    {
+        out[i] = tile_ids[i] < tile_uvs.size() ? tile_uvs[tile_ids[i]] : UVRect {};
+    }
 }
 
 const PropertyMap* TileSet::getTileProperties(uint32_t tile) const
 {
-    if (auto it = tile_properties.find(tile); it != tile_properties.end())
+    if (!metadata || tile >= metadata->property_index.size() || metadata->property_index[tile] == NO_METADATA)
     {
-        return &it->second;
+        return nullptr;
     }
-    return nullptr;
+    return &metadata->properties[metadata->property_index[tile]];
 }
 
 const Animation* TileSet::getTileAnimation(uint32_t tile) const
 {
-    if (auto it = tile_animations.find(tile); it != tile_animations.end())
+    if (!metadata || tile >= metadata->animation_index.size() || metadata->animation_index[tile] == NO_METADATA)
     {
-        return &it->second;
+        return nullptr;
     }
-    return nullptr;
+    return &metadata->animations[metadata->animation_index[tile]];
+}
+
+Result<TileMap> TileMap::fromTMX(const std::string& path, std::ostream* warnings)
+{
+    return fromTMX(path, LoadOptions {}, warnings);
+}
+
+Result<TileMap> TileMap::fromTMX(const std::string& path, const LoadOptions& options, std::ostream* warnings)
+{
+    detail::LoadBuffers buffers {};
+    return load(path, options, buffers, warnings);
 }
 
-Result<TileMap> TileMap::fromTMX(const std::string& path, [[maybe_unused]] std::ostream* warnings)
+Result<TileMap> TileMap::load(const std::string& path, const LoadOptions& options, detail::LoadBuffers& buffers, [[maybe_unused]] std::ostream* warnings)
 {
+    Validator validator { options, "[Tilemap]", path };
+
     auto base = detail::getDirectory(path);
-    auto extension = detail::getExtension(path);
 
-    if (extension != ".tmx" && extension != ".xml")
+    if (validator.isEnabled())
     {
-        Error err { std::string("[Tilemap] Not .tmx or .xml file: ") + path };
-        return tl::make_unexpected(err);
+        auto extension = detail::getExtension(path);
+
+        if (extension != ".tmx" && extension != ".xml")
+        {
+            Error err { std::string("[Tilemap] Not .tmx or .xml file: ") + path };
+            return tl::make_unexpected(err);
+        }
     }
 
-    std::string text = detail::getFileContents(path);
-    if (text.empty())
+    std::string& text = buffers.map_text;
+    if (!detail::readFileContents(path, text) || text.empty())
     {
-        Error err { std::string("[Tileset] file not found or unable to open: ") + path };
+        Error err { std::string("[Tilemap] file not found or unable to open: ") + path };
         return tl::make_unexpected(err);
     }
 
-    rapidxml::xml_document<char> document {};
-    document.parse<0>(text.data());
+    auto* resource = getResource(options);
 
     TileMap out {};
 
-    if (auto map_node = document.first_node("map"))
+    // Retained text moves to the map, string properties then point into it
+    if (options.retain_source)
     {
-        // Parse map data
+        out.strings = allocateUnique<StringStore>(resource, resource);
+    }
+
+    StringStore* retained = out.strings.get();
+    std::string_view source = retained ? retained->retainSource(std::move(text)) : std::string_view(text);
 
-        out.map_size.x = getIntAttribute(map_node, "width").value_or(0);
-        out.map_size.y = getIntAttribute(map_node, "height").value_or(0);
-        out.map_tile_size.x = getIntAttribute(map_node, "tilewidth").value_or(0);
-        out.map_tile_size.y = getIntAttribute(map_node, "tileheight").value_or(0);
+    detail::XmlReader reader { source };
+    detail::XmlTag map_tag {};
 
-        // Custom Properties
+    bool found_map = false;
 
-        out.custom_properties = tryGetProperties(map_node);
+    // Whether resolved_tiles covers every tileset read so far. TMX allows tilesets after layers
+    bool tile_table_built = false;
 
-        // Parse all tilesets
+    CompactTable compact_table { buffers.compact_lookup };
 
-        std::vector<uint32_t> first_gids {};
-        for (auto tileset = map_node->first_node("tileset"); tileset != nullptr; tileset = tileset->next_sibling("tileset"))
+    while (reader.nextChild(map_tag))
+    {
+        if (map_tag.element != XmlElement::Map)
         {
-            std::string path = tileset->first_attribute("source")->value();
-            first_gids.emplace_back(detail::parseInt(tileset->first_attribute("firstgid")->value()).value());
+            reader.skip(map_tag);
+            continue;
+        }
+
+        found_map = true;
+
+        // Parse map data
+
+        readMapAttributes(validator, map_tag, out.map_size, out.map_tile_size);
+
+        if (map_tag.is_empty)
+        {
+            continue;
+        }
 
-            auto tileset_result = TileSet::fromTSX(detail::resolvePath(base, path));
+        // Clamp the requested region to the map
 
-            if (tileset)
+        URect region { {}, out.map_size };
+        if (options.region)
+        {
+            region.start.x = std::min(options.region->start.x, out.map_size.x);
+            region.start.y = std::min(options.region->start.y, out.map_size.y);
+            region.size.x = std::min(options.region->size.x, out.map_size.x - region.start.x);
+            region.size.y = std::min(options.region->size.y, out.map_size.y - region.start.y);
+        }
+
+        // Tilesets are sorted by first gid
+        auto& first_gids = out.first_gids;
+
+        detail::XmlTag child {};
+        while (reader.nextChild(child))
+        {
+            switch (child.element)
+            {
+            case XmlElement::Properties:
             {
+                // Custom Properties
+                if (options.load_properties)
+                    out.custom_properties = tryGetProperties(reader, child, validator, resource, retained);
+                else
+                    reader.skip(child);
+                break;
+            }
+            case XmlElement::TileSet:
+            {
+                TileSetInfo info = readTileSetReference(validator, child, base, first_gids.empty() ? 0 : first_gids.back());
+                reader.skip(child);
+
+                if (validator.failed())
+                {
+                    return tl::make_unexpected(validator.takeError());
+                }
+
+                first_gids.emplace_back(info.first_gid);
+
+                auto tileset_result = TileSet::load(info.source, options, buffers, warnings);
+
+                if (!tileset_result)
+                {
+                    Error e { "[Tilemap] Error Loading Tileset\n" + tileset_result.error().message };
+                    return tl::make_unexpected(e);
+                }
+
+                // The gid range sizes the resolved tile table, so it has to fit in a gid even when trusted
+                uint64_t gid_end = uint64_t(info.first_gid) + tileset_result->getTileCount();
+                if (gid_end > uint64_t(TileID::MAX_GID) + 1)
+                {
+                    Error e { "[Tilemap] tileset gids out of range: " + path };
+                    return tl::make_unexpected(e);
+                }
+
+                if (!out.tile_sets.empty())
+                {
+                    validator.check(info.first_gid >= uint64_t(first_gids[first_gids.size() - 2]) + out.tile_sets.back().getTileCount(),
+                        "tileset gid ranges overlap");
+                }
+
                 out.tile_sets.emplace_back(std::move(tileset_result.value()));
+
+                // Layers after this tileset need its gids
+                tile_table_built = false;
+                break;
             }
-            else
+            case XmlElement::Layer:
             {
-                Error e { "[Tilemap] Error Loading Tileset\n" + tileset_result.error().message };
-                return tl::make_unexpected(e);
+                if (!tile_table_built)
+                {
+                    out.buildTileTable();
+                    tile_table_built = true;
+                }
+
+                TileLayer mapped_layer {};
+
+                if (child.has(XmlAttribute::Name))
+                {
+                    mapped_layer.name = detail::decodeEntities(child.get(XmlAttribute::Name));
+                }
+
+                if (options.layer_filter && !options.layer_filter(mapped_layer.name))
+                {
+                    reader.skip(child);
+                    break;
+                }
+
+                mapped_layer.origin = region.start;
+
+                if (child.is_empty)
+                {
+                    mapped_layer.tiles = Array2D<TileID>(region.size.x, region.size.y);
+                    out.tile_layers.emplace_back(std::move(mapped_layer));
+                    break;
+                }
+
+                detail::XmlTag layer_child {};
+                while (reader.nextChild(layer_child))
+                {
+                    if (layer_child.element == XmlElement::Data)
+                    {
+                        std::string_view encoding = layer_child.get(XmlAttribute::Encoding);
+
+                        if (layer_child.has(XmlAttribute::Compression))
+                        {
+                            Error e { "[Tilemap] Compressed tile data is not supported: " + path };
+                            return tl::make_unexpected(e);
+                        }
+
+                        std::string_view data = reader.readText(layer_child);
+                        std::vector<uint32_t>& tile_indices = buffers.gids;
+
+                        if (encoding == "csv")
+                        {
+                            detail::parseCSVRegion(data, out.map_size, region, tile_indices);
+                        }
+                        else if (encoding == "base64")
+                        {
+                            detail::parseBase64Region(data, out.map_size, region, tile_indices);
+                        }
+                        else
+                        {
+                            Error e { "[Tilemap] Unsupported tile data encoding: " + path };
+                            return tl::make_unexpected(e);
+                        }
+
+                        size_t expected_count = static_cast<size_t>(region.size.x) * region.size.y;
+
+                        if (validator.isEnabled())
+                        {
+                            validator.check(tile_indices.size() == expected_count, "layer data does not match the map size");
+
+                            // The region parsers stop at the end of the map, extra cells are only found by counting
+                            size_t map_cell_count = static_cast<size_t>(out.map_size.x) * out.map_size.y;
+                            size_t data_count = encoding == "csv" ? detail::countCSVValues(data) : detail::countBase64Values(data);
+                            validator.check(data_count <= map_cell_count, "layer data has more cells than the map size");
+
+                            // Every gid has to be empty or belong to a tileset
+                            bool gids_in_range = true;
+                            for (uint32_t gid : tile_indices)
+                            {
+                                TileID tile_id { gid };
+                                gids_in_range = gids_in_range && (!tile_id.isValid() || out.getTileSetIndex(tile_id) != INVALID_TILESET);
+                            }
+
+                            validator.check(gids_in_range, "tile gid out of range of all tilesets");
+
+                            if (validator.failed())
+                            {
+                                return tl::make_unexpected(validator.takeError());
+                            }
+                        }
+
+                        tile_indices.resize(expected_count);
+
+                        LayerStorage storage = options.layer_storage == LayerStorage::Automatic
+                            ? chooseLayerStorage(region.size, tile_indices, compact_table.tiles->size(), buffers)
+                            : options.layer_storage;
+
+                        switch (storage)
+                        {
+                        case LayerStorage::RunLength:
+                            mapped_layer.tiles = RunLengthGrid<TileID>::fromRowMajor(region.size, tile_indices.begin());
+                            break;
+                        case LayerStorage::Sparse:
+                            mapped_layer.tiles = SparseGrid<TileID>::fromRowMajor(region.size, tile_indices.begin());
+                            break;
+                        case LayerStorage::Paletted:
+                            if (auto paletted = PalettedGrid<TileID>::tryFromRowMajor(region.size, tile_indices.begin()))
+                            {
+                                mapped_layer.tiles = std::move(*paletted);
+                                break;
+                            }
+
+                            // Too many distinct tiles for a palette, keep the layer dense
+                            mapped_layer.tiles = makeDenseTiles(region.size, tile_indices);
+                            break;
+                        case LayerStorage::Compact16:
+                            if (compact_table.encode(region.size, tile_indices, mapped_layer))
+                            {
+                                break;
+                            }
+
+                            // Out of indices, keep the layer dense
+                            [[fallthrough]];
+                        default:
+                            mapped_layer.tiles = makeDenseTiles(region.size, tile_indices);
+                            break;
+                        }
+                    }
+                    else if (layer_child.element == XmlElement::Properties && options.load_properties)
+                    {
+                        // Custom Properties
+                        mapped_layer.custom_properties = tryGetProperties(reader, layer_child, validator, resource, retained);
+                    }
+                    else
+                    {
+                        reader.skip(layer_child);
+                    }
+                }
+
+                // Layers without data are left empty
+                if (mapped_layer.size().x != region.size.x || mapped_layer.size().y != region.size.y)
+                {
+                    mapped_layer.tiles = Array2D<TileID>(region.size.x, region.size.y);
+                }
+
+                out.tile_layers.emplace_back(std::move(mapped_layer));
+                break;
+            }
+            default:
+                reader.skip(child);
+                break;
             }
         }
+    }
 
-        std::sort(first_gids.begin(), first_gids.end());
+    if (!tile_table_built)
+    {
+        out.buildTileTable();
+    }
 
-        // Parse all layer data
+    if (validator.isEnabled())
+    {
+        validator.check(!reader.hasError(), "malformed XML");
+        validator.check(found_map, "no <map> element found");
 
-        for (auto layer = map_node->first_node("layer"); layer != nullptr; layer = layer->next_sibling("layer"))
+        if (validator.failed())
         {
-            std::string_view csv_data = { layer->first_node("data")->value(), layer->first_node("data")->value_size() };
+            return tl::make_unexpected(validator.takeError());
+        }
+    }
+
+    return out;
+}
+
+Result<MapInfo> TileMap::probe(const std::string& path)
+{
+    return probe(path, LoadOptions {});
+}
+
+Result<MapInfo> TileMap::probe(const std::string& path, const LoadOptions& options)
+{
+    Validator validator { options, "[Tilemap]", path };
 
-            auto tile_indices = detail::parseCSV(csv_data);
+    auto base = detail::getDirectory(path);
 
-            TileLayer mapped_layer {};
+    if (validator.isEnabled())
+    {
+        auto extension = detail::getExtension(path);
 
-            if (auto attribute = layer->first_attribute("name"))
+        if (extension != ".tmx" && extension != ".xml")
+        {
+            Error err { std::string("[Tilemap] Not .tmx or .xml file: ") + path };
+            return tl::make_unexpected(err);
+        }
+    }
+
+    std::ifstream file { path, std::ios::binary };
+    if (!file)
+    {
+        Error err { std::string("[Tilemap] file not found or unable to open: ") + path };
+        return tl::make_unexpected(err);
+    }
+
+    auto* resource = getResource(options);
+
+    // The header is usually at the start of the file: read a small prefix, and only read more of the file
+    // (parsing again from the start) if the first layer was not reached yet
+    std::string text {};
+    size_t read_size = 4096;
+
+    while (true)
+    {
+        size_t old_size = text.size();
+        text.resize(old_size + read_size);
+        file.read(text.data() + old_size, static_cast<std::streamsize>(read_size));
+        text.resize(old_size + static_cast<size_t>(file.gcount()));
+
+        bool whole_file = !file;
+        bool reached_layers = false;
+        bool found_map = false;
+
+        detail::XmlReader reader { text };
+        detail::XmlTag map_tag {};
+
+        MapInfo out {};
+
+        while (!reached_layers && reader.nextChild(map_tag))
+        {
+            if (map_tag.element != XmlElement::Map)
             {
-                mapped_layer.name = attribute->value();
+                reader.skip(map_tag);
+                continue;
             }
 
-            mapped_layer.tile_ids = Array2D<TileID>(out.map_size.x, out.map_size.y);
+            found_map = true;
+            readMapAttributes(validator, map_tag, out.map_size, out.map_tile_size);
 
-            size_t index = 0;
-            for (auto& tile_id : mapped_layer.tile_ids)
+            if (map_tag.is_empty)
             {
-                tile_id = calculateTileID(first_gids, tile_indices.at(index++));
+                break;
+            }
+
+            detail::XmlTag child {};
+            while (reader.nextChild(child))
+            {
+                if (child.element == XmlElement::Layer)
+                {
+                    reached_layers = true;
+                    break;
+                }
+                else if (child.element == XmlElement::Properties)
+                {
+                    if (options.load_properties)
+                        out.custom_properties = tryGetProperties(reader, child, validator, resource);
+                    else
+                        reader.skip(child);
+                }
+                else if (child.element == XmlElement::TileSet)
+                {
+                    uint32_t previous_first_gid = out.tile_sets.empty() ? 0 : out.tile_sets.back().first_gid;
+                    out.tile_sets.emplace_back(readTileSetReference(validator, child, base, previous_first_gid));
+                    reader.skip(child);
+                }
+                else
+                {
+                    reader.skip(child);
+                }
             }
+        }
+
+        if (reached_layers || whole_file)
+        {
+            if (validator.isEnabled())
+            {
+                validator.check(reached_layers || !reader.hasError(), "malformed XML");
+                validator.check(found_map, "no <map> element found");
 
-            // Custom Properties
-            mapped_layer.custom_properties = tryGetProperties(layer);
-            out.tile_layers.emplace_back(std::move(mapped_layer));
+                if (validator.failed())
+                {
+                    return tl::make_unexpected(validator.takeError());
+                }
+            }
+            return out;
         }
+
+        read_size *= 4;
     }
+}
 
-    return out;
+UVec2 TileLayer::size() const
+{
+    return std::visit([](const auto& grid)
+        { return grid.size(); },
+        tiles);
+}
+
+TileID TileLayer::at(uint32_t x, uint32_t y) const
+{
+    return std::visit([x, y](const auto& grid)
+        { return grid.at(x, y); },
+        tiles);
+}
+
+void TileLayer::copyRow(uint32_t y, TileID* out) const
+{
+    std::visit([y, out](const auto& grid)
+        { grid.copyRow(y, out); },
+        tiles);
+}
+
+void TileLayer::copyRegion(const URect& region, const Array2DView<TileID>& out) const
+{
+    if (const auto* dense = getDense())
+    {
+        tpp::copyRegion(dense->view(region), out);
+        return;
+    }
+
+    if (!(region.size == out.size()))
+    {
+        throw std::invalid_argument("copyRegion view sizes do not match");
+    }
+    if (region.start.x > size().x || region.size.x > size().x - region.start.x
+        || region.start.y > size().y || region.size.y > size().y - region.start.y)
+    {
+        throw std::out_of_range("TileLayer region out of bounds");
+    }
+
+    std::vector<TileID> row(size().x);
+    for (uint32_t y = 0; y < region.size.y; ++y)
+    {
+        copyRow(region.start.y + y, row.data());
+        std::copy_n(row.begin() + region.start.x, region.size.x, out.row(y).begin());
+    }
+}
+
+Array2D<TileID>& TileLayer::makeDense()
+{
+    if (auto* dense = std::get_if<Array2D<TileID>>(&tiles))
+    {
+        return *dense;
+    }
+
+    UVec2 layer_size = size();
+    Array2D<TileID> dense(layer_size.x, layer_size.y);
+    copyRegion({ { 0, 0 }, layer_size }, dense.view());
+
+    return tiles.emplace<Array2D<TileID>>(std::move(dense));
+}
+
+void TileMap::buildTileTable()
+{
+    // load() bounds every range by MAX_GID, so the table never exceeds 2^28 entries
+    size_t gid_count = 1;
+    for (size_t i = 0; i < tile_sets.size(); ++i)
+    {
+        gid_count = std::max(gid_count, size_t(first_gids[i]) + tile_sets[i].getTileCount());
+    }
+
+    resolved_tiles.assign(gid_count, ResolvedTile {});
+
+    for (size_t i = 0; i < tile_sets.size(); ++i)
+    {
+        const TileSet& tileset = tile_sets[i];
+
+        for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+        {
+            ResolvedTile& out = resolved_tiles[size_t(first_gids[i]) + tile];
+
+            out.tileset = static_cast<uint32_t>(i);
+            out.tile_index = tile;
+            out.rect = tileset.getTileRects()[tile];
+            out.uvs = tileset.getTileUVs()[tile];
+
+            if (!tileset.getTileUVQuads().empty())
+                out.uv_quads = &tileset.getTileUVQuads()[tile * TileID::ORIENTATION_COUNT];
+            out.properties = tileset.getTileProperties(tile);
+            out.animation = tileset.getTileAnimation(tile);
+
+            out.flags = ResolvedTile::VALID;
+            if (out.properties)
+                out.flags |= ResolvedTile::HAS_PROPERTIES;
+            if (out.animation)
+                out.flags |= ResolvedTile::HAS_ANIMATION;
+        }
+    }
 }
 
 const TileLayer* TileMap::findTileLayer(const std::string& name) const
@@ -313,3 +1186,36 @@ TileLayer* TileMap::findTileLayer(const std::string& name)
 {
     return const_cast<TileLayer*>(std::as_const(*this).findTileLayer(name));
 }
+
+Loader::Loader(const LoadOptions& options)
+    : options(options)
+    , buffers(std::make_unique<detail::LoadBuffers>())
+{
+}
+
+Loader::~Loader() = default;
+Loader::Loader(Loader&&) noexcept = default;
+Loader& Loader::operator=(Loader&&) noexcept = default;
+
+Result<TileMap> Loader::loadMap(const std::string& path, std::ostream* warnings)
+{
+    if (!buffers)
+    {
+        buffers = std::make_unique<detail::LoadBuffers>();
+    }
+    return TileMap::load(path, options, *buffers, warnings);
+}
+
+Result<TileSet> Loader::loadTileSet(const std::string& path, std::ostream* warnings)
+{
+    if (!buffers)
+    {
+        buffers = std::make_unique<detail::LoadBuffers>();
+    }
+    return TileSet::load(path, options, *buffers, warnings);
+}
+
+void Loader::releaseBuffers()
+{
+    buffers.reset();
+}
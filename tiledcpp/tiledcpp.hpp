@@ -2,11 +2,20 @@
 
 #include "tiledcpp/config.hpp"
 
+#include <functional>
+#include <memory_resource>
 #include <optional>
+#include <string_view>
+#include <variant>
 
 #include "tiledcpp/types/array2d.hpp"
 #include "tiledcpp/types/image.hpp"
+#include "tiledcpp/types/paletted_grid.hpp"
 #include "tiledcpp/types/properties.hpp"
+#include "tiledcpp/types/resource_ptr.hpp"
+#include "tiledcpp/types/run_length_grid.hpp"
+#include "tiledcpp/types/sparse_grid.hpp"
+#include "tiledcpp/types/string_store.hpp"
 
 namespace tpp
 {
@@ -19,13 +28,103 @@ struct TILEDCPP_API KeyFrame
 
 struct TILEDCPP_API Animation
 {
-    std::vector<KeyFrame> frames {};
+    // Points into the frames of all the animations of the tileset, which are stored back to back
+    Span<const KeyFrame> frames {};
 };
 
+enum class ValidationMode
+{
+    // Checks every element, attribute and tile gid, returning an Error for anything missing or malformed.
+    // Use for user made or otherwise untrusted content
+    Validate,
+
+    // Skips all checks, including file extensions and path canonicalization.
+    // Only for content known to be valid (e.g. shipped with the game), malformed files may load garbage
+    Trusted
+};
+
+// Containers a tile layer can be stored in
+enum class LayerStorage : uint8_t
+{
+    // Array2D, fastest access
+    Dense,
+
+    // RunLengthGrid, for layers with long horizontal stretches of the same tile
+    RunLength,
+
+    // SparseGrid, for mostly empty layers
+    Sparse,
+
+    // PalettedGrid, for layers using few distinct tiles.
+    // Falls back to Dense for layers with more than 65536 distinct tiles (flip flags included)
+    Paletted,
+
+    // Array2D<uint16_t> of indices into a table shared by all the layers of the map,
+    // for maps using less than 65536 distinct tiles (flip flags included). Falls back to Dense otherwise
+    Compact16,
+
+    // Only valid in LoadOptions: picks the storage using the least memory for every layer,
+    // falling back to Dense unless another storage at least halves its size
+    Automatic
+};
+
+// Controls which parts of a map or tileset get loaded. The defaults load everything,
+// turning things off lets e.g. headless servers skip work they do not need
+struct TILEDCPP_API LoadOptions
+{
+    ValidationMode validation = ValidationMode::Validate;
+
+    // If false, tileset images are not decoded: the Image only holds the size declared in the <image> tag
+    bool load_images = true;
+
+    // If true, tile UVs are moved half a texel inwards on every side, so that linear filtering
+    // does not bleed in texels of neighbouring tiles. See TileSet::getTileUVs()
+    bool inset_uvs = false;
+
+    // If true, tilesets also store UV quads for the 8 flipped / rotated orientations of every tile,
+    // see TileSet::getTileUVQuads(). Costs 256 bytes per tile: with large tilesets, calling orientUVs()
+    // on the tile UVs is often faster than the cache misses of reading the table
+    bool orientation_uvs = false;
+
+    // If false, custom properties of maps, layers, tilesets and tiles are skipped
+    bool load_properties = true;
+
+    // If false, tile animations are skipped
+    bool load_animations = true;
+
+    // If set, only tile layers whose name passes the filter are loaded
+    std::function<bool(std::string_view)> layer_filter {};
+
+    // If set, tile layers only load the tiles inside this rectangle (in tiles), see TileLayer::origin.
+    // Data outside of the region is skipped without being decoded
+    std::optional<URect> region {};
+
+    // Container used for tile layers, see TileLayer::storage
+    LayerStorage layer_storage = LayerStorage::Dense;
+
+    // Where names, properties and animations get allocated (tile data always uses the heap).
+    // Pass e.g. a std::pmr::monotonic_buffer_resource to keep the thousands of small allocations
+    // of a map in one arena, released at once after the map is destroyed. nullptr uses the default resource
+    std::pmr::memory_resource* memory_resource = nullptr;
+
+    // If true, the file text stays alive inside the map or tileset, and string properties are std::string_views
+    // into it instead of copies. Values with entities get decoded into an arena owned by the map or tileset
+    bool retain_source = false;
+};
+
+class Loader;
+
+namespace detail
+{
+// Scratch memory used while loading, kept alive between loads by tpp::Loader
+struct LoadBuffers;
+}
+
 class TILEDCPP_API TileSet
 {
 public:
     TileSet() = default;
+    explicit TileSet(std::pmr::memory_resource* resource);
 
     // Non copyable
     TileSet(const TileSet&) = delete;
@@ -36,8 +135,24 @@ public:
     TileSet& operator=(TileSet&&) = default;
 
     static Result<TileSet> fromTSX(const std::string& path, std::ostream* warnings = nullptr);
+    static Result<TileSet> fromTSX(const std::string& path, const LoadOptions& options, std::ostream* warnings = nullptr);
 
+    // Source rectangle of a tile in the image, in pixels. Returns null optional if tile_id is out of range
     std::optional<URect> getTileRect(uint32_t tile_id) const;
+
+    // Source rectangles and UVs (normalized by the image size) of every tile, indexed by tile id.
+    // Computed when loading, see LoadOptions::inset_uvs
+    Span<const URect> getTileRects() const { return Span<const URect>(tile_rects.data(), tile_rects.size()); }
+    Span<const UVRect> getTileUVs() const { return Span<const UVRect>(tile_uvs.data(), tile_uvs.size()); }
+
+    // UV quads of every tile in all of its orientations, at tile_id * TileID::ORIENTATION_COUNT + orientation.
+    // Only computed when loading with LoadOptions::orientation_uvs, empty otherwise
+    Span<const UVQuad> getTileUVQuads() const { return Span<const UVQuad>(tile_uv_quads.data(), tile_uv_quads.size()); }
+
+    // Batch lookups: writes the rect / UVs of every tile id to out, which must hold tile_ids.size() elements.
+    // Out of range ids get empty rects
+    void getTileRects(Span<const uint32_t> tile_ids, URect* out) const;
+    void getTileUVs(Span<const uint32_t> tile_ids, UVRect* out) const;
     uint32_t getTileCount() const { return tile_count; }
     UVec2 getTileSize() const { return tile_size; }
 
@@ -56,11 +171,46 @@ public:
     const Animation* getTileAnimation(uint32_t tile) const;
 
 private:
-    std::unique_ptr<PropertyMap> custom_properties {};
+    friend class Loader;
+    friend class TileMap;
+
+    static Result<TileSet> load(const std::string& path, const LoadOptions& options, detail::LoadBuffers& buffers, std::ostream* warnings);
+
+    static constexpr uint32_t NO_METADATA = 0xFFFFFFFF;
 
-    std::unordered_map<uint32_t, PropertyMap> tile_properties {};
-    std::unordered_map<uint32_t, Animation> tile_animations {};
+    // Fills the rect and UV tables, once the image size is known
+    void buildTileTables(const LoadOptions& options);
 
+    // Metadata of all the tiles, in flat arrays indexed by tile id.
+    // Kept behind a pointer so that the frame spans stay valid when the tileset moves
+    struct TileMetadata
+    {
+        explicit TileMetadata(std::pmr::memory_resource* resource)
+            : property_index(resource)
+            , properties(resource)
+            , animation_index(resource)
+            , animations(resource)
+            , frames(resource)
+        {
+        }
+
+        // Index into properties / animations for every tile id, NO_METADATA for tiles without any.
+        // Left empty if no tile has properties / animations
+        std::pmr::vector<uint32_t> property_index;
+        std::pmr::vector<PropertyMap> properties;
+
+        std::pmr::vector<uint32_t> animation_index;
+        std::pmr::vector<Animation> animations;
+
+        // Frames of every animation, back to back
+        std::pmr::vector<KeyFrame> frames;
+    };
+
+    ResourcePtr<PropertyMap> custom_properties {};
+    ResourcePtr<TileMetadata> metadata {};
+
+    // Text that retained string properties point into, only set with LoadOptions::retain_source
+    ResourcePtr<StringStore> strings {};
     std::string name {};
     Image image {};
 
@@ -71,46 +221,261 @@ private:
     uint32_t spacing {};
 
     UVec2 tile_size {};
+
+    // Indexed by tile id
+    std::vector<URect> tile_rects {};
+    std::vector<UVRect> tile_uvs {};
+    std::vector<UVQuad> tile_uv_quads {};
 };
 
-// Tile id: contains tileset and tile index for a map tile position
+// Tile id: a map cell packed in 32 bits, the global tile id (gid) plus the flip / rotation flags in the top 4 bits.
+// Use TileMap::getTileSetIndex() and TileMap::getTileIndex() to find the tileset and tile it refers to.
 // Can be invalid if the tile is empty, check with isValid()
 class TILEDCPP_API TileID
 {
 public:
+    enum TileFlags : uint32_t
+    {
+        FLIPPED_HORIZONTALLY_FLAG = 0x80000000,
+        FLIPPED_VERTICALLY_FLAG = 0x40000000,
+        FLIPPED_DIAGONALLY_FLAG = 0x20000000,
+        ROTATED_HEXAGONAL_120_FLAG = 0x10000000,
+
+        FLAG_MASK = 0xF0000000
+    };
+
     TileID() = default;
-    TileID(uint32_t tileset, uint32_t flag_id);
+    explicit TileID(uint32_t raw)
+        : raw(raw)
+    {
+    }
+
+    // Largest global tile id that fits next to the flags
+    static constexpr uint32_t MAX_GID = ~FLAG_MASK;
 
-    uint32_t getId() const;
-    uint32_t getTileset() const;
+    // Global tile id, without flags
+    uint32_t getGid() const { return raw & ~FLAG_MASK; }
 
-    bool isFlippedHorizontally() const;
-    bool isFlippedVertically() const;
+    // Global tile id and flags, as stored in the map file
+    uint32_t getRaw() const { return raw; }
+
+    // Number of orthogonal orientations, see getOrientation()
+    static constexpr uint32_t ORIENTATION_COUNT = 8;
+
+    // The horizontal, vertical and diagonal flip flags packed in 0-7 (horizontal = 4, vertical = 2, diagonal = 1).
+    // 0 is the unflipped tile, e.g. 5 is rotated 90 degrees clockwise. Index for orientUVs() and TileSet::getTileUVQuads()
+    uint32_t getOrientation() const { return raw >> 29; }
+
+    bool isFlippedHorizontally() const { return raw & FLIPPED_HORIZONTALLY_FLAG; }
+    bool isFlippedVertically() const { return raw & FLIPPED_VERTICALLY_FLAG; }
+    bool isFlippedDiagonally() const { return raw & FLIPPED_DIAGONALLY_FLAG; }
+    bool isRotatedHexagonal120() const { return raw & ROTATED_HEXAGONAL_120_FLAG; }
 
     // Empty map tiles are not valid
-    bool isValid() const { return flag_id != INVALID_ID; }
+    bool isValid() const { return getGid() != 0; }
+
+    bool operator==(const TileID& o) const { return raw == o.raw; }
+    bool operator!=(const TileID& o) const { return raw != o.raw; }
 
 private:
-    enum TileFlags : uint32_t
+    uint32_t raw {};
+};
+
+static_assert(sizeof(TileID) == 4, "TileID must stay packed in 32 bits");
+
+namespace detail
+{
+
+// Corner of the source rect (bit 0: right, bit 1: bottom) drawn at every corner of the quad, per orientation.
+// Tiled flips diagonally first, then horizontally, then vertically: undo them in reverse order
+constexpr uint8_t orientationCorner(uint32_t orientation, uint32_t corner)
+{
+    constexpr uint8_t QUAD_X[4] = { 0, 1, 1, 0 };
+    constexpr uint8_t QUAD_Y[4] = { 0, 0, 1, 1 };
+
+    uint8_t x = QUAD_X[corner];
+    uint8_t y = QUAD_Y[corner];
+
+    if (orientation & 2)
+        y ^= 1;
+    if (orientation & 4)
+        x ^= 1;
+    if (orientation & 1)
+        return static_cast<uint8_t>(y | (x << 1));
+
+    return static_cast<uint8_t>(x | (y << 1));
+}
+
+struct OrientationTable
+{
+    uint8_t corners[TileID::ORIENTATION_COUNT][4] {};
+
+    constexpr OrientationTable()
     {
-        FLIPPED_HORIZONTALLY_FLAG = 0x80000000,
-        FLIPPED_VERTICALLY_FLAG = 0x40000000,
-        FLIPPED_DIAGONALLY_FLAG = 0x20000000,
-        ROTATED_HEXAGONAL_120_FLAG = 0x10000000,
+        for (uint32_t orientation = 0; orientation < TileID::ORIENTATION_COUNT; ++orientation)
+            for (uint32_t corner = 0; corner < 4; ++corner)
+                corners[orientation][corner] = orientationCorner(orientation, corner);
+    }
+};
 
-        FLAG_MASK = 0xF0000000,
-        INVALID_ID = 0xFFFFFFFF
-    };
+inline constexpr OrientationTable ORIENTATIONS {};
+
+}
+
+// UVs of the 4 quad corners drawing a tile with the given orientation (TileID::getOrientation()), without any branching
+inline UVQuad orientUVs(const UVRect& uvs, uint32_t orientation)
+{
+    const float u[2] = { uvs.u0, uvs.u1 };
+    const float v[2] = { uvs.v0, uvs.v1 };
+
+    UVQuad out {};
+    for (uint32_t corner = 0; corner < 4; ++corner)
+    {
+        uint8_t source = detail::ORIENTATIONS.corners[orientation][corner];
+        out.corners[corner] = TexCoord { u[source & 1], v[source >> 1] };
+    }
+    return out;
+}
 
-    uint32_t tileset = INVALID_ID;
-    uint32_t flag_id = INVALID_ID;
+}
+
+template <>
+struct std::hash<tpp::TileID>
+{
+    size_t operator()(const tpp::TileID& id) const { return std::hash<uint32_t> {}(id.getRaw()); }
+};
+
+namespace tpp
+{
+
+// Compact16 storage: ids index into table, index 0 is always the empty tile.
+// All the Compact16 layers of a map share the same table
+struct TILEDCPP_API CompactTileGrid
+{
+    Array2D<uint16_t> ids;
+    std::shared_ptr<const std::vector<TileID>> table {};
+
+    UVec2 size() const { return ids.size(); }
+    TileID at(uint32_t x, uint32_t y) const { return (*table)[ids.at(x, y)]; }
+
+    void copyRow(uint32_t y, TileID* out) const
+    {
+        for (uint16_t index : ids.row(y))
+        {
+            *out++ = (*table)[index];
+        }
+    }
+
+    template <typename F>
+    void forEachNonEmpty(F&& fn) const
+    {
+        ids.forEachNonEmpty([&fn, this](uint32_t x, uint32_t y, uint16_t index)
+            { fn(x, y, (*table)[index]); });
+    }
 };
 
 struct TILEDCPP_API TileLayer
 {
+    // One container per LayerStorage, in the same order
+    using Tiles = std::variant<Array2D<TileID>, RunLengthGrid<TileID>, SparseGrid<TileID>, PalettedGrid<TileID>, CompactTileGrid>;
+
     std::string name {};
-    Array2D<TileID> tile_ids;
-    std::unique_ptr<PropertyMap> custom_properties {};
+
+    // The accessors of the layer work the same for every container
+    Tiles tiles {};
+
+    // Map position of tile (0, 0). Only non zero when loading with LoadOptions::region
+    UVec2 origin {};
+
+    ResourcePtr<PropertyMap> custom_properties {};
+
+    LayerStorage storage() const { return static_cast<LayerStorage>(tiles.index()); }
+
+    UVec2 size() const;
+
+    // Empty tiles return an invalid TileID
+    TileID at(uint32_t x, uint32_t y) const;
+    TileID at(const UVec2& xy) const { return at(xy.x, xy.y); }
+
+    // Writes the size().x tiles of row y to out
+    void copyRow(uint32_t y, TileID* out) const;
+
+    // Copies a region of the layer into out, which must have the region's size
+    void copyRegion(const URect& region, const Array2DView<TileID>& out) const;
+
+    // Converts the tiles to dense storage, if they are not stored that way already, and returns them.
+    // Editing (fill, blit, copyRegion into the layer) works on the views of the returned array
+    Array2D<TileID>& makeDense();
+
+    // nullptr unless the layer uses LayerStorage::Dense
+    const Array2D<TileID>* getDense() const { return std::get_if<Array2D<TileID>>(&tiles); }
+
+    // Calls fn(x, y, tile) for every valid tile, in row major order
+    template <typename F>
+    void forEachNonEmpty(F&& fn) const
+    {
+        std::visit([&fn](const auto& grid)
+            { grid.forEachNonEmpty(fn); },
+            tiles);
+    }
+};
+
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<size_t>(LayerStorage::Compact16), TileLayer::Tiles>, CompactTileGrid>,
+    "TileLayer::Tiles must follow the order of LayerStorage");
+
+struct TILEDCPP_API TileSetInfo
+{
+    uint32_t first_gid {};
+
+    // Resolved path to the .tsx file
+    std::string source {};
+};
+
+// Map metadata returned by TileMap::probe(), without any layer data or tileset images
+struct TILEDCPP_API MapInfo
+{
+    UVec2 map_size {};
+    UVec2 map_tile_size {};
+
+    std::vector<TileSetInfo> tile_sets {};
+
+    // nullptr if the map does not have any properties
+    ResourcePtr<PropertyMap> custom_properties {};
+};
+
+// Everything needed to draw or query a gid, resolved once per map. See TileMap::resolve()
+struct TILEDCPP_API ResolvedTile
+{
+    enum Flags : uint32_t
+    {
+        // Set for every gid belonging to a tileset
+        VALID = 1 << 0,
+        HAS_PROPERTIES = 1 << 1,
+        HAS_ANIMATION = 1 << 2
+    };
+
+    // Index into TileMap::getTileSets(), TileMap::INVALID_TILESET if not VALID
+    uint32_t tileset = 0xFFFFFFFF;
+
+    // Index of the tile inside its tileset
+    uint32_t tile_index {};
+
+    // Source rectangle in the tileset image, in pixels
+    URect rect {};
+
+    // rect normalized by the size of the tileset image
+    UVRect uvs {};
+
+    // UV quads of the tile, indexed by TileID::getOrientation(). nullptr unless loaded with LoadOptions::orientation_uvs
+    const UVQuad* uv_quads {};
+
+    // Point into the tileset, nullptr if the tile has none
+    const PropertyMap* properties {};
+    const Animation* animation {};
+
+    uint32_t flags {};
+
+    bool isValid() const { return flags & VALID; }
 };
 
 class TILEDCPP_API TileMap
@@ -127,6 +492,14 @@ public:
     TileMap& operator=(TileMap&&) = default;
 
     static Result<TileMap> fromTMX(const std::string& path, std::ostream* warnings = nullptr);
+    static Result<TileMap> fromTMX(const std::string& path, const LoadOptions& options, std::ostream* warnings = nullptr);
+
+    // Reads only the map header: sizes, tileset list and map properties.
+    // Stops at the first layer, so no layer data, tilesets or images are loaded
+    static Result<MapInfo> probe(const std::string& path);
+
+    // Same, with the validation mode, memory resource and load_properties of options
+    static Result<MapInfo> probe(const std::string& path, const LoadOptions& options);
 
     std::vector<TileSet>& getTileSets() { return tile_sets; }
     std::vector<TileLayer>& getTileLayers() { return tile_layers; }
@@ -145,13 +518,83 @@ public:
     UVec2 getMapGridSize() const { return map_size; }
     UVec2 getMapTileSize() const { return map_tile_size; }
 
+    static constexpr uint32_t INVALID_TILESET = 0xFFFFFFFF;
+
+    // Tileset, source rectangle, UVs, properties and animation of a tile (flip flags are ignored), in one array read.
+    // Empty tiles and gids outside of every tileset return an entry that is not valid.
+    // Built when loading: the entries point into the tilesets, which must not be replaced afterwards
+    const ResolvedTile& resolve(TileID tile) const
+    {
+        static const ResolvedTile empty {};
+
+        uint32_t gid = tile.getGid();
+        return gid < resolved_tiles.size() ? resolved_tiles[gid] : empty;
+    }
+
+    // Entries of every gid, indexed by gid
+    Span<const ResolvedTile> getResolvedTiles() const { return Span<const ResolvedTile>(resolved_tiles.data(), resolved_tiles.size()); }
+
+    // Index into getTileSets() of the tileset a tile belongs to.
+    // Returns INVALID_TILESET for empty tiles or gids outside of every tileset
+    uint32_t getTileSetIndex(TileID tile) const { return resolve(tile).tileset; }
+
+    // Index of a tile inside its tileset. The tile must belong to a tileset
+    uint32_t getTileIndex(TileID tile) const { return resolve(tile).tile_index; }
+
+    // First gid of every tileset, in the same order as getTileSets()
+    const std::vector<uint32_t>& getFirstGids() const { return first_gids; }
+
+    // The map file text, only kept when loading with LoadOptions::retain_source
+    std::string_view getSource() const { return strings ? strings->getSource() : std::string_view {}; }
+
 private:
+    friend class Loader;
+
+    static Result<TileMap> load(const std::string& path, const LoadOptions& options, detail::LoadBuffers& buffers, std::ostream* warnings);
+
+    // Resolves every gid of the tilesets
+    void buildTileTable();
+
     std::vector<TileSet> tile_sets {};
+    std::vector<uint32_t> first_gids {};
+    std::vector<ResolvedTile> resolved_tiles {};
     std::vector<TileLayer> tile_layers {};
 
     UVec2 map_size {};
     UVec2 map_tile_size {};
 
-    std::unique_ptr<PropertyMap> custom_properties {};
+    ResourcePtr<PropertyMap> custom_properties {};
+
+    // Text that retained string properties point into, only set with LoadOptions::retain_source
+    ResourcePtr<StringStore> strings {};
 };
+
+// Loads maps and tilesets with the same options, keeping the file text, tile and hash table buffers of
+// previous loads. Once the buffers fit the largest file, the only allocations left are the ones of
+// the returned objects (which can come from LoadOptions::memory_resource).
+// Use for level streaming or other workloads loading many files. Not thread safe, use one Loader per thread
+class TILEDCPP_API Loader
+{
+public:
+    explicit Loader(const LoadOptions& options = {});
+    ~Loader();
+
+    // Movable
+    Loader(Loader&&) noexcept;
+    Loader& operator=(Loader&&) noexcept;
+
+    Result<TileMap> loadMap(const std::string& path, std::ostream* warnings = nullptr);
+    Result<TileSet> loadTileSet(const std::string& path, std::ostream* warnings = nullptr);
+
+    const LoadOptions& getOptions() const { return options; }
+    void setOptions(const LoadOptions& new_options) { options = new_options; }
+
+    // Frees the buffers, e.g. after loading an unusually large file
+    void releaseBuffers();
+
+private:
+    LoadOptions options {};
+    std::unique_ptr<detail::LoadBuffers> buffers;
+};
+
 }
\ No newline at end of file
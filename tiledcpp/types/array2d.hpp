@@ -1,51 +1,79 @@
 #pragma once
 #include "tiledcpp/config.hpp"
 
+#include "tiledcpp/types/array2d_layout.hpp"
+#include "tiledcpp/types/array2d_view.hpp"
 #include "tiledcpp/types/math.hpp"
+#include "tiledcpp/types/span.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <stdexcept>
 #include <vector>
 
 namespace tpp
 {
 
-// Iterator for Array2D, also allows for getting the 2D position of the element in the array
-template <typename T>
+// Random access iterator for Array2D, also allows for getting the 2D position of the element in the array.
+// Always walks the elements in row order, whatever the memory layout of the array.
+// With RowMajorLayout the elements are contiguous, so &*(it + n) == &*it + n
+template <typename T, typename Layout = RowMajorLayout>
 class Array2DIterator
 {
 private:
-    static constexpr bool IS_CONST = std::is_const_v<T>;
-
-    using Self = Array2DIterator<T>;
-    using Value = std::remove_const_t<T>;
-
-    using UnderlyingIterator = std::conditional_t<
-        IS_CONST,
-        typename std::vector<Value>::const_iterator,
-        typename std::vector<Value>::iterator>;
+    using Self = Array2DIterator<T, Layout>;
 
 public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
     Array2DIterator() = default;
-    Array2DIterator(UnderlyingIterator base, UnderlyingIterator iterator, uint32_t stride);
+    Array2DIterator(T* base, const Layout& layout, size_t offset, uint32_t stride);
+
+    T& operator*() const;
+    T* operator->() const;
+    T& operator[](difference_type n) const { return *(*this + n); }
 
-    T& operator*();
-    T* operator->();
     Self& operator++();
-    Self& operator++(int);
+    Self operator++(int);
+    Self& operator--();
+    Self operator--(int);
+
+    Self& operator+=(difference_type n);
+    Self& operator-=(difference_type n) { return *this += -n; }
+    Self operator+(difference_type n) const { return Self(*this) += n; }
+    Self operator-(difference_type n) const { return Self(*this) += -n; }
+    friend Self operator+(difference_type n, const Self& it) { return it + n; }
+    difference_type operator-(const Self& other) const;
+
     bool operator==(const Self& other) const;
     bool operator!=(const Self& other) const;
+    bool operator<(const Self& other) const { return offset < other.offset; }
+    bool operator>(const Self& other) const { return offset > other.offset; }
+    bool operator<=(const Self& other) const { return offset <= other.offset; }
+    bool operator>=(const Self& other) const { return offset >= other.offset; }
 
     // Returns the array position of the iterator
-    tpp::UVec2 getPosition() const;
+    tpp::UVec2 getIndices() const;
 
 private:
-    UnderlyingIterator base {};
-    UnderlyingIterator iterator {};
+    T* base {};
+    Layout layout {};
+
+    // Position in row order
+    size_t offset {};
     uint32_t stride {};
 };
 
-// Fixed size 2D Array
-template <typename T>
+// Fixed size 2D Array.
+// Layout controls how the elements are stored in memory, see array2d_layout.hpp:
+// RowMajorLayout is best for full scans, ChunkedLayout and ZOrderLayout for reading 2D neighbourhoods.
+// Access and iteration work the same for every layout
+template <typename T, typename Layout = RowMajorLayout>
 class Array2D
 {
 public:
@@ -59,136 +87,285 @@ public:
     T& at(const UVec2& ij) { return at(ij.x, ij.y); }
     const T& at(const UVec2& ij) const { return at(ij.x, ij.y); }
 
+    // Unchecked access, for hot loops where the position is known to be valid
+    T& operator()(uint32_t x, uint32_t y) { return elements[layout.getIndex(x, y)]; }
+    const T& operator()(uint32_t x, uint32_t y) const { return elements[layout.getIndex(x, y)]; }
+
     UVec2 size() const { return array_size; }
 
-    Array2DIterator<T> begin();
-    Array2DIterator<T> end();
+    // Underlying storage, in the order given by Layout (including any padding)
+    T* data() { return elements.data(); }
+    const T* data() const { return elements.data(); }
+    size_t getStorageSize() const { return elements.size(); }
+
+    // The contiguous elements of row y, only available with RowMajorLayout
+    Span<T> row(uint32_t y);
+    Span<const T> row(uint32_t y) const;
 
-    Array2DIterator<const T> begin() const;
-    Array2DIterator<const T> end() const;
+    // Views of the whole array or a region of it, only available with RowMajorLayout.
+    // See copyRegion() and blit() in array2d_view.hpp for block copies between views
+    Array2DView<T> view();
+    Array2DView<const T> view() const;
+    Array2DView<T> view(const URect& region) { return view().subView(region); }
+    Array2DView<const T> view(const URect& region) const { return view().subView(region); }
+
+    void fill(const T& value) { std::fill(elements.begin(), elements.end(), value); }
+    void fill(const URect& region, const T& value) { view(region).fill(value); }
+
+    // Writes the size().x values of row y to out
+    void copyRow(uint32_t y, T* out) const;
+
+    // Calls fn(x, y, value) for every value that is not equal to T {}, in row major order
+    template <typename F>
+    void forEachNonEmpty(F&& fn) const;
+
+    Array2DIterator<T, Layout> begin();
+    Array2DIterator<T, Layout> end();
+
+    Array2DIterator<const T, Layout> begin() const;
+    Array2DIterator<const T, Layout> end() const;
 
 private:
     UVec2 array_size {};
-    std::vector<T> data;
+    Layout layout {};
+    std::vector<T> elements {};
 };
 
-template <typename T>
-Array2DIterator<T>::Array2DIterator(UnderlyingIterator base, UnderlyingIterator iterator, uint32_t stride)
+template <typename T, typename Layout>
+Array2DIterator<T, Layout>::Array2DIterator(T* base, const Layout& layout, size_t offset, uint32_t stride)
     : base(base)
-    , iterator(iterator)
+    , layout(layout)
+    , offset(offset)
     , stride(stride)
 {
 }
 
-template <typename T>
-T& Array2DIterator<T>::operator*()
+template <typename T, typename Layout>
+T& Array2DIterator<T, Layout>::operator*() const
 {
-    return *iterator;
+    if constexpr (Layout::IS_ROW_MAJOR)
+    {
+        return base[offset];
+    }
+    else
+    {
+        return base[layout.getIndex(static_cast<uint32_t>(offset % stride), static_cast<uint32_t>(offset / stride))];
+    }
 }
 
-template <typename T>
-T* Array2DIterator<T>::operator->()
+template <typename T, typename Layout>
+T* Array2DIterator<T, Layout>::operator->() const
 {
-    return &(*iterator);
+    return &(**this);
 }
 
-template <typename T>
-Array2DIterator<T>& Array2DIterator<T>::operator++()
+template <typename T, typename Layout>
+Array2DIterator<T, Layout>& Array2DIterator<T, Layout>::operator++()
 {
-    ++iterator;
+    ++offset;
     return *this;
 }
 
-template <typename T>
-Array2DIterator<T>& Array2DIterator<T>::operator++(int)
+template <typename T, typename Layout>
+Array2DIterator<T, Layout> Array2DIterator<T, Layout>::operator++(int)
 {
     Self temp = *this;
     ++(*this);
     return temp;
 }
 
-template <typename T>
-bool Array2DIterator<T>::operator==(const Self& other) const
+template <typename T, typename Layout>
+Array2DIterator<T, Layout>& Array2DIterator<T, Layout>::operator--()
 {
-    return iterator == other.iterator;
+    --offset;
+    return *this;
 }
 
-template <typename T>
-bool Array2DIterator<T>::operator!=(const Self& other) const
+template <typename T, typename Layout>
+Array2DIterator<T, Layout> Array2DIterator<T, Layout>::operator--(int)
+{
+    Self temp = *this;
+    --(*this);
+    return temp;
+}
+
+template <typename T, typename Layout>
+Array2DIterator<T, Layout>& Array2DIterator<T, Layout>::operator+=(difference_type n)
+{
+    offset = static_cast<size_t>(static_cast<difference_type>(offset) + n);
+    return *this;
+}
+
+template <typename T, typename Layout>
+typename Array2DIterator<T, Layout>::difference_type Array2DIterator<T, Layout>::operator-(const Self& other) const
+{
+    return static_cast<difference_type>(offset) - static_cast<difference_type>(other.offset);
+}
+
+template <typename T, typename Layout>
+bool Array2DIterator<T, Layout>::operator==(const Self& other) const
+{
+    return offset == other.offset;
+}
+
+template <typename T, typename Layout>
+bool Array2DIterator<T, Layout>::operator!=(const Self& other) const
 {
     return !(*this == other);
 }
 
-template <typename T>
-UVec2 Array2DIterator<T>::getIndices() const
+template <typename T, typename Layout>
+UVec2 Array2DIterator<T, Layout>::getIndices() const
 {
-    auto offset = std::distance(base, iterator);
     return UVec2 {
         static_cast<uint32_t>(offset % stride),
         static_cast<uint32_t>(offset / stride)
     };
 }
 
-template <typename T>
-Array2D<T>::Array2D(uint32_t width, uint32_t height)
+template <typename T, typename Layout>
+Array2D<T, Layout>::Array2D(uint32_t width, uint32_t height)
     : array_size(width, height)
-    , data(width * height)
+    , layout(array_size)
+    , elements(layout.getStorageSize())
 {
 }
 
-template <typename T>
-Array2D<T>::Array2D(uint32_t width, uint32_t height, const T& init)
+template <typename T, typename Layout>
+Array2D<T, Layout>::Array2D(uint32_t width, uint32_t height, const T& init)
     : array_size(width, height)
-    , data(width * height, init)
+    , layout(array_size)
+    , elements(layout.getStorageSize(), init)
 {
 }
 
-template <typename T>
-T& Array2D<T>::at(uint32_t x, uint32_t y)
+template <typename T, typename Layout>
+T& Array2D<T, Layout>::at(uint32_t x, uint32_t y)
 {
     if (x >= array_size.x || y >= array_size.y)
     {
         throw std::out_of_range("Array2D index out of bounds");
     }
-    return data[y * array_size.x + x];
+    return elements[layout.getIndex(x, y)];
 }
 
-template <typename T>
-const T& Array2D<T>::at(uint32_t x, uint32_t y) const
+template <typename T, typename Layout>
+const T& Array2D<T, Layout>::at(uint32_t x, uint32_t y) const
 {
     if (x >= array_size.x || y >= array_size.y)
     {
         throw std::out_of_range("Array2D index out of bounds");
     }
-    return data[y * array_size.x + x];
+    return elements[layout.getIndex(x, y)];
+}
+
+template <typename T, typename Layout>
+Span<T> Array2D<T, Layout>::row(uint32_t y)
+{
+    static_assert(Layout::IS_ROW_MAJOR, "Rows are only contiguous with RowMajorLayout");
+
+    if (y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D row out of bounds");
+    }
+    return Span<T>(elements.data() + layout.getIndex(0, y), array_size.x);
+}
+
+template <typename T, typename Layout>
+Span<const T> Array2D<T, Layout>::row(uint32_t y) const
+{
+    static_assert(Layout::IS_ROW_MAJOR, "Rows are only contiguous with RowMajorLayout");
+
+    if (y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D row out of bounds");
+    }
+    return Span<const T>(elements.data() + layout.getIndex(0, y), array_size.x);
+}
+
+template <typename T, typename Layout>
+Array2DView<T> Array2D<T, Layout>::view()
+{
+    static_assert(Layout::IS_ROW_MAJOR, "Views are only available with RowMajorLayout");
+    return Array2DView<T>(elements.data(), array_size, array_size.x);
 }
 
-template <typename T>
-Array2DIterator<T> Array2D<T>::begin()
+template <typename T, typename Layout>
+Array2DView<const T> Array2D<T, Layout>::view() const
 {
-    Array2DIterator<T> it(data.begin(), data.begin(), array_size.x);
+    static_assert(Layout::IS_ROW_MAJOR, "Views are only available with RowMajorLayout");
+    return Array2DView<const T>(elements.data(), array_size, array_size.x);
+}
+
+template <typename T, typename Layout>
+void Array2D<T, Layout>::copyRow(uint32_t y, T* out) const
+{
+    if (y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D row out of bounds");
+    }
+
+    if constexpr (Layout::IS_ROW_MAJOR)
+    {
+        std::copy_n(elements.begin() + layout.getIndex(0, y), array_size.x, out);
+    }
+    else
+    {
+        for (uint32_t x = 0; x < array_size.x; ++x)
+        {
+            out[x] = elements[layout.getIndex(x, y)];
+        }
+    }
+}
+
+template <typename T, typename Layout>
+template <typename F>
+void Array2D<T, Layout>::forEachNonEmpty(F&& fn) const
+{
+    const T empty {};
+
+    for (uint32_t y = 0; y < array_size.y; ++y)
+    {
+        for (uint32_t x = 0; x < array_size.x; ++x)
+        {
+            const T& value = elements[layout.getIndex(x, y)];
+            if (!(value == empty))
+            {
+                fn(x, y, value);
+            }
+        }
+    }
+}
+
+template <typename T, typename Layout>
+Array2DIterator<T, Layout> Array2D<T, Layout>::begin()
+{
+    Array2DIterator<T, Layout> it(elements.data(), layout, 0, array_size.x);
     return it;
 }
 
-template <typename T>
-Array2DIterator<T> Array2D<T>::end()
+template <typename T, typename Layout>
+Array2DIterator<T, Layout> Array2D<T, Layout>::end()
 {
-    Array2DIterator<T> it(data.begin(), data.end(), array_size.x);
+    Array2DIterator<T, Layout> it(elements.data(), layout, static_cast<size_t>(array_size.x) * array_size.y, array_size.x);
     return it;
 }
 
-template <typename T>
-Array2DIterator<const T> Array2D<T>::begin() const
+template <typename T, typename Layout>
+Array2DIterator<const T, Layout> Array2D<T, Layout>::begin() const
 {
-    Array2DIterator<const T> it(data.begin(), data.begin(), array_size.x);
+    Array2DIterator<const T, Layout> it(elements.data(), layout, 0, array_size.x);
     return it;
 }
 
-template <typename T>
-Array2DIterator<const T> Array2D<T>::end() const
+template <typename T, typename Layout>
+Array2DIterator<const T, Layout> Array2D<T, Layout>::end() const
 {
-    Array2DIterator<const T> it(data.begin(), data.end(), array_size.x);
+    Array2DIterator<const T, Layout> it(elements.data(), layout, static_cast<size_t>(array_size.x) * array_size.y, array_size.x);
     return it;
 }
 
-}
\ No newline at end of file
+}
+
+// Array2D<bool> specialization
+#include "tiledcpp/types/bit_array2d.hpp"
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/types/math.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace tpp
+{
+
+// Memory layouts for Array2D. A layout maps a 2D position to an index in the underlying storage,
+// the storage can be larger than width * height when the layout needs padding.
+//
+// Every layout is built from the array size and provides:
+//   size_t getStorageSize() const
+//   size_t getIndex(uint32_t x, uint32_t y) const
+//   static constexpr bool IS_ROW_MAJOR (storage index == y * width + x)
+
+// Rows one after another. No padding, fastest for full scans in row order
+class RowMajorLayout
+{
+public:
+    static constexpr bool IS_ROW_MAJOR = true;
+
+    RowMajorLayout() = default;
+    explicit RowMajorLayout(const UVec2& size)
+        : size(size)
+    {
+    }
+
+    size_t getStorageSize() const { return static_cast<size_t>(size.x) * size.y; }
+    size_t getIndex(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * size.x + x; }
+
+private:
+    UVec2 size {};
+};
+
+// Square chunks stored one after another in row order, row major inside every chunk.
+// Neighbouring cells share a chunk, so 2D region scans touch far fewer cache lines.
+// Sizes are padded to whole chunks
+template <uint32_t CHUNK_SIZE = 16>
+class ChunkedLayout
+{
+public:
+    static_assert((CHUNK_SIZE & (CHUNK_SIZE - 1)) == 0, "Chunk size must be a power of two");
+
+    static constexpr bool IS_ROW_MAJOR = false;
+
+    ChunkedLayout() = default;
+    explicit ChunkedLayout(const UVec2& size)
+        : chunk_grid_size(chunkCount(size.x), chunkCount(size.y))
+    {
+    }
+
+    size_t getStorageSize() const { return static_cast<size_t>(chunk_grid_size.x) * chunk_grid_size.y * CHUNK_CELLS; }
+
+    size_t getIndex(uint32_t x, uint32_t y) const
+    {
+        size_t chunk = static_cast<size_t>(y / CHUNK_SIZE) * chunk_grid_size.x + x / CHUNK_SIZE;
+        return chunk * CHUNK_CELLS + (y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE;
+    }
+
+private:
+    static constexpr uint32_t CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+
+    // Rounded up in 64 bits, sizes near 2^32 would wrap to 0 chunks
+    static uint32_t chunkCount(uint32_t cells) { return static_cast<uint32_t>((uint64_t(cells) + CHUNK_SIZE - 1) / CHUNK_SIZE); }
+
+    UVec2 chunk_grid_size {};
+};
+
+// Morton (Z) order: the bits of x and y are interleaved, so every aligned power of two square is contiguous.
+// Both sizes are padded to the next power of two. When they differ, the extra bits of the larger one
+// select between Morton ordered squares laid out one after another
+class ZOrderLayout
+{
+public:
+    static constexpr bool IS_ROW_MAJOR = false;
+
+    ZOrderLayout() = default;
+    // Throws std::length_error if the padded size does not fit in a size_t
+    explicit ZOrderLayout(const UVec2& size)
+        : bits_x(log2Ceil(size.x))
+        , bits_y(log2Ceil(size.y))
+        , square_bits(bits_x < bits_y ? bits_x : bits_y)
+    {
+        if (bits_x + bits_y >= sizeof(size_t) * 8)
+        {
+            throw std::length_error("ZOrderLayout size too large");
+        }
+    }
+
+    size_t getStorageSize() const { return size_t(1) << (bits_x + bits_y); }
+
+    size_t getIndex(uint32_t x, uint32_t y) const
+    {
+        uint64_t square_mask = (uint64_t(1) << square_bits) - 1;
+        uint64_t square = bits_x > bits_y ? x >> square_bits : y >> square_bits;
+
+        return static_cast<size_t>((square << (2 * square_bits))
+            | spreadBits(x & square_mask)
+            | (spreadBits(y & square_mask) << 1));
+    }
+
+private:
+    static uint32_t log2Ceil(uint32_t value)
+    {
+        uint32_t bits = 0;
+        while ((uint64_t(1) << bits) < value)
+        {
+            ++bits;
+        }
+        return bits;
+    }
+
+    // Inserts a zero bit between every bit of a 32 bit value
+    static uint64_t spreadBits(uint64_t value)
+    {
+        value = (value | (value << 16)) & 0x0000FFFF0000FFFFull;
+        value = (value | (value << 8)) & 0x00FF00FF00FF00FFull;
+        value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        value = (value | (value << 2)) & 0x3333333333333333ull;
+        value = (value | (value << 1)) & 0x5555555555555555ull;
+        return value;
+    }
+
+    uint32_t bits_x {};
+    uint32_t bits_y {};
+    uint32_t square_bits {};
+};
+
+}
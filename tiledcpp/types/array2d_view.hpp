@@ -0,0 +1,158 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/types/math.hpp"
+#include "tiledcpp/types/span.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace tpp
+{
+
+// Non owning rectangular window into row major 2D data, e.g. a region of an Array2D.
+// Rows are contiguous and stride elements apart. Use Array2DView<const T> for read only access
+template <typename T>
+class Array2DView
+{
+public:
+    Array2DView() = default;
+    Array2DView(T* data, const UVec2& size, size_t stride)
+        : ptr(data)
+        , view_size(size)
+        , stride(stride)
+    {
+    }
+
+    // Mutable views convert to read only ones
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    Array2DView(const Array2DView<U>& other)
+        : ptr(other.data())
+        , view_size(other.size())
+        , stride(other.getStride())
+    {
+    }
+
+    T* data() const { return ptr; }
+    UVec2 size() const { return view_size; }
+    size_t getStride() const { return stride; }
+    bool empty() const { return view_size.x == 0 || view_size.y == 0; }
+
+    T& at(uint32_t x, uint32_t y) const
+    {
+        if (x >= view_size.x || y >= view_size.y)
+        {
+            throw std::out_of_range("Array2DView index out of bounds");
+        }
+        return (*this)(x, y);
+    }
+
+    T& at(const UVec2& xy) const { return at(xy.x, xy.y); }
+
+    // Unchecked access
+    T& operator()(uint32_t x, uint32_t y) const { return ptr[y * stride + x]; }
+
+    Span<T> row(uint32_t y) const
+    {
+        if (y >= view_size.y)
+        {
+            throw std::out_of_range("Array2DView row out of bounds");
+        }
+        return Span<T>(ptr + y * stride, view_size.x);
+    }
+
+    // Window into this view, throws if the rectangle does not fit
+    Array2DView subView(const URect& rect) const
+    {
+        if (rect.start.x > view_size.x || rect.size.x > view_size.x - rect.start.x
+            || rect.start.y > view_size.y || rect.size.y > view_size.y - rect.start.y)
+        {
+            throw std::out_of_range("Array2DView region out of bounds");
+        }
+        return Array2DView(ptr + rect.start.y * stride + rect.start.x, rect.size, stride);
+    }
+
+    void fill(const T& value) const
+    {
+        for (uint32_t y = 0; y < view_size.y; ++y)
+        {
+            std::fill_n(ptr + y * stride, view_size.x, value);
+        }
+    }
+
+private:
+    T* ptr {};
+    UVec2 view_size {};
+    size_t stride {};
+};
+
+namespace detail
+{
+
+// Row by row copy that also handles views overlapping in the same array
+template <typename S, typename D>
+void copyRows(const Array2DView<S>& src, const Array2DView<D>& dst)
+{
+    const std::remove_const_t<S>* src_data = src.data();
+    D* dst_data = dst.data();
+
+    // Copy from the end when the destination starts after the source, like memmove
+    bool backwards = std::less<const void*>()(src_data, dst_data);
+
+    for (uint32_t i = 0; i < src.size().y; ++i)
+    {
+        uint32_t y = backwards ? src.size().y - 1 - i : i;
+
+        const auto* from = src_data + y * src.getStride();
+        auto* to = dst_data + y * dst.getStride();
+
+        if (backwards)
+            std::copy_backward(from, from + src.size().x, to + src.size().x);
+        else
+            std::copy(from, from + src.size().x, to);
+    }
+}
+
+}
+
+// Copies src into dst row by row, both views must have the same size
+template <typename S, typename D>
+void copyRegion(const Array2DView<S>& src, const Array2DView<D>& dst)
+{
+    static_assert(std::is_same_v<std::remove_const_t<S>, D>, "copyRegion needs views of the same type, with a mutable destination");
+
+    if (!(src.size() == dst.size()))
+    {
+        throw std::invalid_argument("copyRegion view sizes do not match");
+    }
+    detail::copyRows(src, dst);
+}
+
+// Copies src into dst with its top left corner at position (which may be negative),
+// clipping everything that falls outside of dst. Used for stamping prefabs into layers
+template <typename S, typename D>
+void blit(const Array2DView<S>& src, const Array2DView<D>& dst, const IVec2& position)
+{
+    static_assert(std::is_same_v<std::remove_const_t<S>, D>, "blit needs views of the same type, with a mutable destination");
+
+    // Clip in 64 bits, positions and sizes can use the full 32 bit range
+    int64_t start_x = std::max<int64_t>(position.x, 0);
+    int64_t start_y = std::max<int64_t>(position.y, 0);
+    int64_t end_x = std::min<int64_t>(int64_t(position.x) + src.size().x, dst.size().x);
+    int64_t end_y = std::min<int64_t>(int64_t(position.y) + src.size().y, dst.size().y);
+
+    if (start_x >= end_x || start_y >= end_y)
+    {
+        return;
+    }
+
+    UVec2 size { static_cast<uint32_t>(end_x - start_x), static_cast<uint32_t>(end_y - start_y) };
+    UVec2 src_start { static_cast<uint32_t>(start_x - position.x), static_cast<uint32_t>(start_y - position.y) };
+    UVec2 dst_start { static_cast<uint32_t>(start_x), static_cast<uint32_t>(start_y) };
+
+    detail::copyRows(src.subView({ src_start, size }), dst.subView({ dst_start, size }));
+}
+
+}
@@ -0,0 +1,527 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/types/array2d.hpp"
+
+#include <iterator>
+#include <optional>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace tpp
+{
+
+namespace detail
+{
+
+inline uint32_t popCount(uint64_t word)
+{
+#if defined(_MSC_VER)
+    return static_cast<uint32_t>(__popcnt64(word));
+#else
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+#endif
+}
+
+// Index of the lowest set bit, word must not be 0
+inline uint32_t countTrailingZeros(uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index {};
+    _BitScanForward64(&index, word);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+#endif
+}
+
+}
+
+// Bitset specialization of Array2D for masks (collision, visibility, walkable...).
+// Every row is stored as whole 64 bit words, bit x % 64 of word x / 64 holds cell x.
+// Bits past the width of a row are always 0, so word level operations can be used directly on the rows.
+// Only the row major layout is supported.
+// Cells are not addressable, so accessors and iterators return a Reference proxy (like std::vector<bool>),
+// and rowWords() / data() take the place of row() / view()
+template <typename Layout>
+class Array2D<bool, Layout>
+{
+    static_assert(Layout::IS_ROW_MAJOR, "Array2D<bool> only supports RowMajorLayout");
+
+public:
+    using Word = uint64_t;
+    static constexpr uint32_t WORD_BITS = 64;
+
+    // Proxy returned by the non const accessors
+    class Reference
+    {
+    public:
+        Reference(Word& word, Word mask)
+            : word(word)
+            , mask(mask)
+        {
+        }
+
+        operator bool() const { return (word & mask) != 0; }
+
+        Reference& operator=(bool value)
+        {
+            word = value ? (word | mask) : (word & ~mask);
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) { return *this = static_cast<bool>(other); }
+
+    private:
+        Word& word;
+        Word mask;
+    };
+
+    // Random access iterator over the cells in row major order, with the same getIndices() as Array2DIterator
+    template <bool IS_CONST>
+    class BitIterator
+    {
+    private:
+        using Self = BitIterator<IS_CONST>;
+        using WordPointer = std::conditional_t<IS_CONST, const Word*, Word*>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = bool;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::conditional_t<IS_CONST, bool, Reference>;
+
+        BitIterator() = default;
+        BitIterator(WordPointer words, size_t offset, uint32_t width, uint32_t words_per_row)
+            : words(words)
+            , offset(offset)
+            , width(width)
+            , words_per_row(words_per_row)
+        {
+        }
+
+        reference operator*() const
+        {
+            uint32_t x = static_cast<uint32_t>(offset % width);
+            size_t index = offset / width * words_per_row + x / WORD_BITS;
+
+            if constexpr (IS_CONST)
+                return (words[index] & bitMask(x)) != 0;
+            else
+                return Reference(words[index], bitMask(x));
+        }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        Self& operator++() { return *this += 1; }
+        Self operator++(int) { Self temp = *this; ++(*this); return temp; }
+        Self& operator--() { return *this += -1; }
+        Self operator--(int) { Self temp = *this; --(*this); return temp; }
+
+        Self& operator+=(difference_type n)
+        {
+            offset = static_cast<size_t>(static_cast<difference_type>(offset) + n);
+            return *this;
+        }
+        Self& operator-=(difference_type n) { return *this += -n; }
+        Self operator+(difference_type n) const { return Self(*this) += n; }
+        Self operator-(difference_type n) const { return Self(*this) += -n; }
+        friend Self operator+(difference_type n, const Self& it) { return it + n; }
+        difference_type operator-(const Self& other) const { return static_cast<difference_type>(offset) - static_cast<difference_type>(other.offset); }
+
+        bool operator==(const Self& other) const { return offset == other.offset; }
+        bool operator!=(const Self& other) const { return offset != other.offset; }
+        bool operator<(const Self& other) const { return offset < other.offset; }
+        bool operator>(const Self& other) const { return offset > other.offset; }
+        bool operator<=(const Self& other) const { return offset <= other.offset; }
+        bool operator>=(const Self& other) const { return offset >= other.offset; }
+
+        // Returns the array position of the iterator
+        UVec2 getIndices() const { return UVec2 { static_cast<uint32_t>(offset % width), static_cast<uint32_t>(offset / width) }; }
+
+    private:
+        WordPointer words {};
+
+        // Position in row order
+        size_t offset {};
+        uint32_t width {};
+        uint32_t words_per_row {};
+    };
+
+    using iterator = BitIterator<false>;
+    using const_iterator = BitIterator<true>;
+
+    Array2D() = default;
+    Array2D(uint32_t width, uint32_t height);
+    Array2D(uint32_t width, uint32_t height, bool init);
+
+    Reference at(uint32_t x, uint32_t y);
+    bool at(uint32_t x, uint32_t y) const;
+
+    Reference at(const UVec2& xy) { return at(xy.x, xy.y); }
+    bool at(const UVec2& xy) const { return at(xy.x, xy.y); }
+
+    // Unchecked access
+    Reference operator()(uint32_t x, uint32_t y) { return Reference(words[wordIndex(x, y)], bitMask(x)); }
+    bool operator()(uint32_t x, uint32_t y) const { return (words[wordIndex(x, y)] & bitMask(x)) != 0; }
+
+    UVec2 size() const { return array_size; }
+
+    uint32_t getWordsPerRow() const { return words_per_row; }
+
+    // The words of row y. Keep the bits past the width at 0 when writing to them
+    Span<Word> rowWords(uint32_t y);
+    Span<const Word> rowWords(uint32_t y) const;
+
+    Word* data() { return words.data(); }
+    const Word* data() const { return words.data(); }
+
+    // Sets every cell, or the cells of a region (which must be inside the array), a word at a time
+    void fill(bool value);
+    void fill(const URect& region, bool value);
+
+    // Word level boolean operations, both arrays must have the same size
+    Array2D& operator&=(const Array2D& other);
+    Array2D& operator|=(const Array2D& other);
+    Array2D& operator^=(const Array2D& other);
+
+    // Removes the cells set in other
+    Array2D& subtract(const Array2D& other);
+
+    // Inverts every cell
+    Array2D& flip();
+
+    Array2D operator&(const Array2D& other) const { return Array2D(*this) &= other; }
+    Array2D operator|(const Array2D& other) const { return Array2D(*this) |= other; }
+    Array2D operator^(const Array2D& other) const { return Array2D(*this) ^= other; }
+    Array2D operator~() const { return Array2D(*this).flip(); }
+
+    bool operator==(const Array2D& other) const { return array_size == other.array_size && words == other.words; }
+    bool operator!=(const Array2D& other) const { return !(*this == other); }
+
+    // Number of set cells
+    size_t count() const;
+    uint32_t countRow(uint32_t y) const;
+
+    bool any() const;
+
+    // Returns the first set cell of row y at or after x, if any
+    std::optional<uint32_t> findNextSet(uint32_t x, uint32_t y) const;
+
+    // Writes the size().x values of row y to out
+    void copyRow(uint32_t y, bool* out) const;
+
+    // Calls fn(x, y, true) for every set cell, in row major order
+    template <typename F>
+    void forEachNonEmpty(F&& fn) const;
+
+    iterator begin() { return iterator(words.data(), 0, array_size.x, words_per_row); }
+    iterator end() { return iterator(words.data(), cellCount(), array_size.x, words_per_row); }
+
+    const_iterator begin() const { return const_iterator(words.data(), 0, array_size.x, words_per_row); }
+    const_iterator end() const { return const_iterator(words.data(), cellCount(), array_size.x, words_per_row); }
+
+private:
+    size_t wordIndex(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * words_per_row + x / WORD_BITS; }
+    static Word bitMask(uint32_t x) { return Word(1) << (x % WORD_BITS); }
+    size_t cellCount() const { return static_cast<size_t>(array_size.x) * array_size.y; }
+
+    // Valid bits of the last word of every row
+    Word lastWordMask() const;
+
+    void checkSameSize(const Array2D& other) const;
+
+    UVec2 array_size {};
+    uint32_t words_per_row {};
+    std::vector<Word> words {};
+};
+
+template <typename Layout>
+Array2D<bool, Layout>::Array2D(uint32_t width, uint32_t height)
+    : Array2D(width, height, false)
+{
+}
+
+template <typename Layout>
+Array2D<bool, Layout>::Array2D(uint32_t width, uint32_t height, bool init)
+    : array_size(width, height)
+    , words_per_row(static_cast<uint32_t>((static_cast<size_t>(width) + WORD_BITS - 1) / WORD_BITS))
+    , words(static_cast<size_t>(words_per_row) * height, init ? ~Word(0) : Word(0))
+{
+    if (init && words_per_row > 0)
+    {
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            words[wordIndex(width - 1, y)] &= lastWordMask();
+        }
+    }
+}
+
+template <typename Layout>
+typename Array2D<bool, Layout>::Reference Array2D<bool, Layout>::at(uint32_t x, uint32_t y)
+{
+    if (x >= array_size.x || y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D index out of bounds");
+    }
+    return (*this)(x, y);
+}
+
+template <typename Layout>
+bool Array2D<bool, Layout>::at(uint32_t x, uint32_t y) const
+{
+    if (x >= array_size.x || y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D index out of bounds");
+    }
+    return (*this)(x, y);
+}
+
+template <typename Layout>
+Span<typename Array2D<bool, Layout>::Word> Array2D<bool, Layout>::rowWords(uint32_t y)
+{
+    if (y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D row out of bounds");
+    }
+    return Span<Word>(words.data() + static_cast<size_t>(y) * words_per_row, words_per_row);
+}
+
+template <typename Layout>
+Span<const typename Array2D<bool, Layout>::Word> Array2D<bool, Layout>::rowWords(uint32_t y) const
+{
+    if (y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D row out of bounds");
+    }
+    return Span<const Word>(words.data() + static_cast<size_t>(y) * words_per_row, words_per_row);
+}
+
+template <typename Layout>
+void Array2D<bool, Layout>::fill(bool value)
+{
+    fill({ { 0, 0 }, array_size }, value);
+}
+
+template <typename Layout>
+void Array2D<bool, Layout>::fill(const URect& region, bool value)
+{
+    if (region.start.x > array_size.x || region.size.x > array_size.x - region.start.x
+        || region.start.y > array_size.y || region.size.y > array_size.y - region.start.y)
+    {
+        throw std::out_of_range("Array2D region out of bounds");
+    }
+
+    if (region.size.x == 0)
+    {
+        return;
+    }
+
+    // Cells [first, last] of every row, split in a partial first word, whole words and a partial last word
+    uint32_t first = region.start.x;
+    uint32_t last = region.start.x + region.size.x - 1;
+    uint32_t first_word = first / WORD_BITS;
+    uint32_t last_word = last / WORD_BITS;
+
+    Word first_mask = ~Word(0) << (first % WORD_BITS);
+    Word last_mask = ~Word(0) >> (WORD_BITS - 1 - last % WORD_BITS);
+
+    auto apply = [value](Word& word, Word mask)
+    {
+        word = value ? (word | mask) : (word & ~mask);
+    };
+
+    for (uint32_t y = region.start.y; y < region.start.y + region.size.y; ++y)
+    {
+        Word* row = words.data() + static_cast<size_t>(y) * words_per_row;
+
+        if (first_word == last_word)
+        {
+            apply(row[first_word], first_mask & last_mask);
+            continue;
+        }
+
+        apply(row[first_word], first_mask);
+        std::fill(row + first_word + 1, row + last_word, value ? ~Word(0) : Word(0));
+        apply(row[last_word], last_mask);
+    }
+}
+
+template <typename Layout>
+typename Array2D<bool, Layout>::Word Array2D<bool, Layout>::lastWordMask() const
+{
+    uint32_t used_bits = array_size.x % WORD_BITS;
+    return used_bits == 0 ? ~Word(0) : (Word(1) << used_bits) - 1;
+}
+
+template <typename Layout>
+void Array2D<bool, Layout>::checkSameSize(const Array2D& other) const
+{
+    if (!(array_size == other.array_size))
+    {
+        throw std::invalid_argument("Array2D sizes do not match");
+    }
+}
+
+template <typename Layout>
+Array2D<bool, Layout>& Array2D<bool, Layout>::operator&=(const Array2D& other)
+{
+    checkSameSize(other);
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] &= other.words[i];
+    }
+    return *this;
+}
+
+template <typename Layout>
+Array2D<bool, Layout>& Array2D<bool, Layout>::operator|=(const Array2D& other)
+{
+    checkSameSize(other);
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] |= other.words[i];
+    }
+    return *this;
+}
+
+template <typename Layout>
+Array2D<bool, Layout>& Array2D<bool, Layout>::operator^=(const Array2D& other)
+{
+    checkSameSize(other);
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] ^= other.words[i];
+    }
+    return *this;
+}
+
+template <typename Layout>
+Array2D<bool, Layout>& Array2D<bool, Layout>::subtract(const Array2D& other)
+{
+    checkSameSize(other);
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] &= ~other.words[i];
+    }
+    return *this;
+}
+
+template <typename Layout>
+Array2D<bool, Layout>& Array2D<bool, Layout>::flip()
+{
+    for (auto& word : words)
+    {
+        word = ~word;
+    }
+
+    if (words_per_row > 0)
+    {
+        for (uint32_t y = 0; y < array_size.y; ++y)
+        {
+            words[wordIndex(array_size.x - 1, y)] &= lastWordMask();
+        }
+    }
+    return *this;
+}
+
+template <typename Layout>
+size_t Array2D<bool, Layout>::count() const
+{
+    size_t total = 0;
+    for (Word word : words)
+    {
+        total += detail::popCount(word);
+    }
+    return total;
+}
+
+template <typename Layout>
+uint32_t Array2D<bool, Layout>::countRow(uint32_t y) const
+{
+    uint32_t total = 0;
+    for (Word word : rowWords(y))
+    {
+        total += detail::popCount(word);
+    }
+    return total;
+}
+
+template <typename Layout>
+bool Array2D<bool, Layout>::any() const
+{
+    return std::any_of(words.begin(), words.end(), [](Word word)
+        { return word != 0; });
+}
+
+template <typename Layout>
+std::optional<uint32_t> Array2D<bool, Layout>::findNextSet(uint32_t x, uint32_t y) const
+{
+    if (y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D row out of bounds");
+    }
+
+    if (x >= array_size.x)
+    {
+        return std::nullopt;
+    }
+
+    const Word* row = words.data() + static_cast<size_t>(y) * words_per_row;
+
+    // Mask out the bits before x in the first word
+    uint32_t word_index = x / WORD_BITS;
+    Word word = row[word_index] & (~Word(0) << (x % WORD_BITS));
+
+    while (true)
+    {
+        if (word != 0)
+        {
+            return word_index * WORD_BITS + detail::countTrailingZeros(word);
+        }
+
+        if (++word_index == words_per_row)
+        {
+            return std::nullopt;
+        }
+        word = row[word_index];
+    }
+}
+
+template <typename Layout>
+void Array2D<bool, Layout>::copyRow(uint32_t y, bool* out) const
+{
+    if (y >= array_size.y)
+    {
+        throw std::out_of_range("Array2D row out of bounds");
+    }
+
+    for (uint32_t x = 0; x < array_size.x; ++x)
+    {
+        out[x] = (*this)(x, y);
+    }
+}
+
+template <typename Layout>
+template <typename F>
+void Array2D<bool, Layout>::forEachNonEmpty(F&& fn) const
+{
+    for (uint32_t y = 0; y < array_size.y; ++y)
+    {
+        const Word* row = words.data() + static_cast<size_t>(y) * words_per_row;
+
+        for (uint32_t i = 0; i < words_per_row; ++i)
+        {
+            // Pop the lowest set bit until the word is empty
+            for (Word word = row[i]; word != 0; word &= word - 1)
+            {
+                fn(i * WORD_BITS + detail::countTrailingZeros(word), y, true);
+            }
+        }
+    }
+}
+
+}
@@ -26,6 +26,13 @@ tpp::Result<tpp::Image> tpp::Image::fromPath(const std::string& path)
     return out;
 }
 
+tpp::Image tpp::Image::fromSize(const UVec2& size)
+{
+    Image out {};
+    out.size = size;
+    return out;
+}
+
 tpp::Pixel tpp::Image::getPixel(const tpp::UVec2& pos) const
 {
     return data.get()[pos.x + pos.y * size.x];
@@ -26,6 +26,9 @@ public:
     // Loads an image from a file.
     static Result<Image> fromPath(const std::string& path);
 
+    // Creates an image with a size but no pixel data, getData() will return nullptr
+    static Image fromSize(const UVec2& size);
+
     // Releases the image data. Useful if you don't need it anymore
     void freeData();
 
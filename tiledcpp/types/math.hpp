@@ -43,6 +43,24 @@ struct TILEDCPP_API URect
     UVec2 size {};
 };
 
+// Texture coordinates of a rectangle, normalized to [0, 1]
+struct TILEDCPP_API UVRect
+{
+    float u0 {}, v0 {};
+    float u1 {}, v1 {};
+};
+
+struct TILEDCPP_API TexCoord
+{
+    float u {}, v {};
+};
+
+// Texture coordinates of the 4 corners of a drawn quad: top left, top right, bottom right, bottom left
+struct TILEDCPP_API UVQuad
+{
+    TexCoord corners[4] {};
+};
+
 struct TILEDCPP_API Pixel
 {
     Pixel() = default;
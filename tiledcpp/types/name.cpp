@@ -0,0 +1,80 @@
+#include "tiledcpp/types/name.hpp"
+
+#include <deque>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+
+struct NameTable
+{
+    std::mutex mutex {};
+    std::unordered_map<std::string_view, const tpp::detail::NameEntry*> lookup {};
+
+    // Entries and their text never move once added
+    std::deque<tpp::detail::NameEntry> entries {};
+    std::pmr::monotonic_buffer_resource text {};
+};
+
+// Never destroyed, names stay valid during static destruction. Name::clearTable() frees the contents
+NameTable& getTable()
+{
+    static NameTable* table = new NameTable();
+    return *table;
+}
+
+}
+
+tpp::Name::Name(std::string_view text)
+{
+    auto& table = getTable();
+    std::lock_guard lock { table.mutex };
+
+    if (auto it = table.lookup.find(text); it != table.lookup.end())
+    {
+        entry = it->second;
+        return;
+    }
+
+    char* stored = static_cast<char*>(table.text.allocate(text.size() + 1, 1));
+    text.copy(stored, text.size());
+    stored[text.size()] = '\0';
+
+    std::string_view stored_text { stored, text.size() };
+    entry = &table.entries.emplace_back(detail::NameEntry { stored_text, detail::hashString(stored_text) });
+    table.lookup.emplace(stored_text, entry);
+}
+
+tpp::Name tpp::Name::find(std::string_view text)
+{
+    auto& table = getTable();
+    std::lock_guard lock { table.mutex };
+
+    Name out {};
+    if (auto it = table.lookup.find(text); it != table.lookup.end())
+    {
+        out.entry = it->second;
+    }
+    return out;
+}
+
+size_t tpp::Name::getInternedCount()
+{
+    auto& table = getTable();
+    std::lock_guard lock { table.mutex };
+
+    return table.entries.size();
+}
+
+void tpp::Name::clearTable()
+{
+    auto& table = getTable();
+    std::lock_guard lock { table.mutex };
+
+    // Swapped with empty containers, clear() would keep the buckets and blocks allocated
+    decltype(table.lookup) {}.swap(table.lookup);
+    decltype(table.entries) {}.swap(table.entries);
+    table.text.release();
+}
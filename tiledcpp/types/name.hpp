@@ -0,0 +1,103 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace tpp
+{
+
+namespace detail
+{
+
+// 32 bit FNV-1a
+constexpr uint32_t hashString(std::string_view text)
+{
+    uint32_t hash = 2166136261u;
+    for (char c : text)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct NameEntry
+{
+    std::string_view text {};
+    uint32_t hash {};
+};
+
+}
+
+// Interned string: every distinct text is stored once, in a global table, so names compare in O(1)
+// and carry their hash. Used as property keys.
+//
+// Only property names are interned, never values, so the table grows by one entry per distinct key
+// ever loaded or created. Nothing is freed until clearTable() is called, which tools loading many
+// unrelated maps (or leak checkers) may want to do between batches.
+// Creating a Name from text locks the table, so keep the names used in hot loops around (e.g. as statics)
+class TILEDCPP_API Name
+{
+public:
+    // Invalid name, not equal to any interned text
+    Name() = default;
+    explicit Name(std::string_view text);
+
+    // Returns the name of text if it was interned before, an invalid Name otherwise. Never grows the table
+    static Name find(std::string_view text);
+
+    // Number of distinct texts interned so far
+    static size_t getInternedCount();
+
+    // Frees every interned text. Every Name created before, including the keys of every PropertyMap,
+    // TileMap and TileSet still alive, is left dangling: only call it once all of them are destroyed
+    // and recreate any static Names afterwards
+    static void clearTable();
+
+    bool isValid() const { return entry != nullptr; }
+
+    std::string_view str() const { return entry ? entry->text : std::string_view {}; }
+    uint32_t hash() const { return entry ? entry->hash : 0; }
+
+    bool operator==(const Name& other) const { return entry == other.entry; }
+    bool operator!=(const Name& other) const { return entry != other.entry; }
+
+private:
+    const detail::NameEntry* entry {};
+};
+
+// Property key hashed at compile time, for fixed names queried in hot loops:
+//   constexpr tpp::Key WALKABLE { "walkable" };
+//   map.get<bool>(WALKABLE);
+// or inline with TPP_KEY("walkable"). Lookups only probe with the precomputed hash and compare the text of
+// keys with the same hash, nothing is interned. The text must outlive the key (string literals do)
+class Key
+{
+public:
+    constexpr explicit Key(std::string_view text)
+        : text(text)
+        , key_hash(detail::hashString(text))
+    {
+    }
+
+    constexpr std::string_view str() const { return text; }
+    constexpr uint32_t hash() const { return key_hash; }
+
+private:
+    std::string_view text {};
+    uint32_t key_hash {};
+};
+
+}
+
+// Key for a string literal, forced to be hashed at compile time
+#define TPP_KEY(text) ([]() { constexpr ::tpp::Key key { text }; return key; }())
+
+template <>
+struct std::hash<tpp::Name>
+{
+    size_t operator()(const tpp::Name& name) const { return name.hash(); }
+};
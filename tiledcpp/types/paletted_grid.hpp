@@ -0,0 +1,320 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/types/math.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TILEDCPP_PALETTE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace tpp
+{
+
+// Fixed size 2D grid that stores a palette of the distinct values, plus every cell as a 4, 8, 12 or 16 bit index into it.
+// Meant for keeping many layers in memory: a layer using less than 256 distinct tiles takes a quarter of the space of an Array2D.
+// Rows are padded to whole 16 byte blocks, so at() stays O(1) and copyRow() can unpack a block of indices at a time.
+// Same read interface as Array2D, RunLengthGrid and SparseGrid, but read only once built
+template <typename T, typename Hash = std::hash<T>>
+class PalettedGrid
+{
+public:
+    // More distinct values than this can not be indexed, see fromRowMajor()
+    static constexpr size_t MAX_PALETTE_SIZE = 1 << 16;
+
+    PalettedGrid() = default;
+
+    // Builds the grid from size.x * size.y values in row major order.
+    // Throws std::length_error if there are more than MAX_PALETTE_SIZE distinct values
+    template <typename Iterator>
+    static PalettedGrid fromRowMajor(const UVec2& size, Iterator values);
+
+    // Same as above, but returns std::nullopt instead of throwing when the values do not fit in a palette
+    template <typename Iterator>
+    static std::optional<PalettedGrid> tryFromRowMajor(const UVec2& size, Iterator values);
+
+    // Bits used per index for a palette of the given size
+    static uint32_t getIndexBits(size_t palette_size);
+
+    // Bytes used by a grid of the given size and palette size, without the container overhead
+    static size_t estimateBytes(const UVec2& size, size_t palette_size);
+
+    T at(uint32_t x, uint32_t y) const;
+    T at(const UVec2& xy) const { return at(xy.x, xy.y); }
+
+    UVec2 size() const { return grid_size; }
+
+    // Writes the size().x values of row y to out
+    void copyRow(uint32_t y, T* out) const;
+
+    // Calls fn(x, y, value) for every value that is not equal to T {}, in row major order
+    template <typename F>
+    void forEachNonEmpty(F&& fn) const;
+
+    const std::vector<T>& getPalette() const { return palette; }
+    uint32_t getIndexBits() const { return index_bits; }
+
+private:
+    static constexpr uint32_t BLOCK_BYTES = 16;
+    static constexpr uint32_t NO_INDEX = 0xFFFFFFFF;
+
+    static size_t getRowStride(uint32_t width, uint32_t bits);
+
+    uint32_t indexAt(const uint8_t* row, uint32_t x) const;
+
+    // Unpacks the indices of the cells [start, start + count) of a row.
+    // 4, 8 and 16 bit indices are unpacked 16 at a time with SSE2 when available, 12 bit ones two at a time
+    // from every 3 bytes. Everything else, including the last cells of a row, goes through indexAt()
+    void unpackIndices(const uint8_t* row, uint32_t start, uint32_t count, uint16_t* out) const;
+
+    UVec2 grid_size {};
+    uint32_t index_bits {};
+    size_t row_stride {};
+
+    // Palette index of T {}, or NO_INDEX if no cell is empty
+    uint32_t empty_index = NO_INDEX;
+
+    std::vector<T> palette {};
+
+    // Rows of packed indices, every row starts on a block boundary.
+    // Indices are little endian, a cell with an odd 4 or 12 bit position starts at the high nibble of its first byte
+    std::vector<uint8_t> indices {};
+};
+
+template <typename T, typename Hash>
+uint32_t PalettedGrid<T, Hash>::getIndexBits(size_t palette_size)
+{
+    if (palette_size <= (1 << 4))
+        return 4;
+    if (palette_size <= (1 << 8))
+        return 8;
+    if (palette_size <= (1 << 12))
+        return 12;
+    return 16;
+}
+
+template <typename T, typename Hash>
+size_t PalettedGrid<T, Hash>::getRowStride(uint32_t width, uint32_t bits)
+{
+    size_t row_bytes = (static_cast<size_t>(width) * bits + 7) / 8;
+    return (row_bytes + BLOCK_BYTES - 1) / BLOCK_BYTES * BLOCK_BYTES;
+}
+
+template <typename T, typename Hash>
+size_t PalettedGrid<T, Hash>::estimateBytes(const UVec2& size, size_t palette_size)
+{
+    return getRowStride(size.x, getIndexBits(palette_size)) * size.y + palette_size * sizeof(T);
+}
+
+template <typename T, typename Hash>
+template <typename Iterator>
+PalettedGrid<T, Hash> PalettedGrid<T, Hash>::fromRowMajor(const UVec2& size, Iterator values)
+{
+    auto out = tryFromRowMajor(size, values);
+    if (!out)
+    {
+        throw std::length_error("PalettedGrid has too many distinct values");
+    }
+    return std::move(*out);
+}
+
+template <typename T, typename Hash>
+template <typename Iterator>
+std::optional<PalettedGrid<T, Hash>> PalettedGrid<T, Hash>::tryFromRowMajor(const UVec2& size, Iterator values)
+{
+    PalettedGrid out {};
+    out.grid_size = size;
+
+    // First pass: build the palette and keep the index of every cell
+    std::unordered_map<T, uint32_t, Hash> lookup {};
+    std::vector<uint16_t> cell_indices(static_cast<size_t>(size.x) * size.y);
+
+    for (auto& cell : cell_indices)
+    {
+        T value = T(*values);
+        ++values;
+
+        auto [it, inserted] = lookup.try_emplace(value, static_cast<uint32_t>(out.palette.size()));
+        if (inserted)
+        {
+            if (out.palette.size() == MAX_PALETTE_SIZE)
+            {
+                return std::nullopt;
+            }
+            out.palette.push_back(value);
+        }
+
+        cell = static_cast<uint16_t>(it->second);
+    }
+
+    if (auto empty = lookup.find(T {}); empty != lookup.end())
+    {
+        out.empty_index = empty->second;
+    }
+
+    // Second pass: pack the indices. One extra byte lets indexAt() always read two bytes
+    out.index_bits = getIndexBits(out.palette.size());
+    out.row_stride = getRowStride(size.x, out.index_bits);
+    out.indices.assign(out.row_stride * size.y + 1, 0);
+
+    for (uint32_t y = 0; y < size.y; ++y)
+    {
+        uint8_t* row = out.indices.data() + y * out.row_stride;
+        const uint16_t* cells = cell_indices.data() + static_cast<size_t>(y) * size.x;
+
+        for (uint32_t x = 0; x < size.x; ++x)
+        {
+            size_t bit = static_cast<size_t>(x) * out.index_bits;
+            uint32_t shifted = static_cast<uint32_t>(cells[x]) << (bit & 7);
+
+            row[bit / 8] |= static_cast<uint8_t>(shifted);
+            row[bit / 8 + 1] |= static_cast<uint8_t>(shifted >> 8);
+        }
+    }
+
+    out.palette.shrink_to_fit();
+    return out;
+}
+
+template <typename T, typename Hash>
+uint32_t PalettedGrid<T, Hash>::indexAt(const uint8_t* row, uint32_t x) const
+{
+    // Indices never span more than two bytes: 4 and 12 bit ones start at a nibble, 8 and 16 bit ones at a byte
+    size_t bit = static_cast<size_t>(x) * index_bits;
+    uint32_t bytes = row[bit / 8] | (static_cast<uint32_t>(row[bit / 8 + 1]) << 8);
+    return (bytes >> (bit & 7)) & ((1u << index_bits) - 1);
+}
+
+template <typename T, typename Hash>
+T PalettedGrid<T, Hash>::at(uint32_t x, uint32_t y) const
+{
+    if (x >= grid_size.x || y >= grid_size.y)
+    {
+        throw std::out_of_range("PalettedGrid index out of bounds");
+    }
+
+    return palette[indexAt(indices.data() + y * row_stride, x)];
+}
+
+template <typename T, typename Hash>
+void PalettedGrid<T, Hash>::unpackIndices(const uint8_t* row, uint32_t start, uint32_t count, uint16_t* out) const
+{
+    uint32_t x = start;
+
+#if defined(TILEDCPP_PALETTE_SSE2)
+    // 16 cells at a time, start is always a multiple of 16 here so every load stays inside the padded row
+    const __m128i zero = _mm_setzero_si128();
+
+    if (index_bits == 8)
+    {
+        for (; x + 16 <= start + count; x += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x - start)), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x - start) + 8), _mm_unpackhi_epi8(bytes, zero));
+        }
+    }
+    else if (index_bits == 4)
+    {
+        const __m128i low_mask = _mm_set1_epi8(0x0F);
+
+        for (; x + 16 <= start + count; x += 16)
+        {
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + x / 2));
+            __m128i low = _mm_and_si128(bytes, low_mask);
+            __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), low_mask);
+
+            // Even cells live in the low nibble
+            __m128i nibbles = _mm_unpacklo_epi8(low, high);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x - start)), _mm_unpacklo_epi8(nibbles, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x - start) + 8), _mm_unpackhi_epi8(nibbles, zero));
+        }
+    }
+    else if (index_bits == 16)
+    {
+        // Already little endian 16 bit values
+        for (; x + 16 <= start + count; x += 16)
+        {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 2));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 2 + 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x - start)), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x - start) + 8), high);
+        }
+    }
+#endif
+
+    if (index_bits == 12)
+    {
+        // Every pair of cells is packed in 3 bytes, start is even so pairs never straddle
+        for (; x + 2 <= start + count; x += 2)
+        {
+            const uint8_t* pair = row + x / 2 * 3;
+            out[x - start] = static_cast<uint16_t>(pair[0] | (pair[1] & 0x0F) << 8);
+            out[x - start + 1] = static_cast<uint16_t>(pair[1] >> 4 | pair[2] << 4);
+        }
+    }
+
+    for (; x < start + count; ++x)
+    {
+        out[x - start] = static_cast<uint16_t>(indexAt(row, x));
+    }
+}
+
+template <typename T, typename Hash>
+void PalettedGrid<T, Hash>::copyRow(uint32_t y, T* out) const
+{
+    if (y >= grid_size.y)
+    {
+        throw std::out_of_range("PalettedGrid row out of bounds");
+    }
+
+    const uint8_t* row = indices.data() + y * row_stride;
+    uint16_t block[16];
+
+    for (uint32_t start = 0; start < grid_size.x; start += 16)
+    {
+        uint32_t count = std::min(16u, grid_size.x - start);
+        unpackIndices(row, start, count, block);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            out[start + i] = palette[block[i]];
+        }
+    }
+}
+
+template <typename T, typename Hash>
+template <typename F>
+void PalettedGrid<T, Hash>::forEachNonEmpty(F&& fn) const
+{
+    uint16_t block[16];
+
+    for (uint32_t y = 0; y < grid_size.y; ++y)
+    {
+        const uint8_t* row = indices.data() + y * row_stride;
+
+        for (uint32_t start = 0; start < grid_size.x; start += 16)
+        {
+            uint32_t count = std::min(16u, grid_size.x - start);
+            unpackIndices(row, start, count, block);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (block[i] != empty_index)
+                {
+                    fn(start + i, y, palette[block[i]]);
+                }
+            }
+        }
+    }
+}
+
+}
@@ -1,9 +1,83 @@
-
 #include "tiledcpp/types/properties.hpp"
 #include "tiledcpp/detail/parse_helpers.hpp"
+#include "tiledcpp/detail/xml_reader.hpp"
+#include "tiledcpp/types/string_store.hpp"
 
 #include <RapidXML/rapidxml.hpp>
 
+bool isStringType(std::string_view type_name)
+{
+    return type_name.empty() || type_name == "string" || type_name == "file";
+}
+
+bool isKnownType(std::string_view type_name)
+{
+    return isStringType(type_name) || type_name == "bool" || type_name == "color" || type_name == "float" || type_name == "int";
+}
+
+// Checks a raw value the way Tiled writes it. Only used when validating, parseCustomProperty falls back to defaults
+bool isValidValue(std::string_view type_name, std::string_view val)
+{
+    if (isStringType(type_name))
+    {
+        return true;
+    }
+    else if (type_name == "bool")
+    {
+        return val == "true" || val == "false";
+    }
+    else if (type_name == "color")
+    {
+        // Unset colours are written as an empty value
+        return val.empty() || (val.size() > 1 && val.front() == '#' && tpp::detail::parseHex(val.substr(1)));
+    }
+    else if (type_name == "float")
+    {
+        return tpp::detail::parseFloat(val).has_value();
+    }
+    else if (type_name == "int")
+    {
+        return tpp::detail::parseInt(val).has_value();
+    }
+    return false;
+}
+
+tpp::Result<tpp::CustomProperty> parseCustomProperty(std::string_view type_name, std::string val)
+{
+    if (isStringType(type_name))
+    {
+        return tpp::CustomProperty { std::move(val) };
+    }
+    else if (type_name == "bool")
+    {
+        return tpp::CustomProperty { val == "true" };
+    }
+    else if (type_name == "color")
+    {
+        std::string_view view = val;
+        if (!view.empty())
+            view.remove_prefix(1);
+
+        auto hex = tpp::detail::parseHex(view).value_or(0xff000000);
+
+        tpp::Pixel colour { hex };
+        return tpp::CustomProperty { colour };
+    }
+    else if (type_name == "float")
+    {
+        return tpp::CustomProperty { tpp::detail::parseFloat(val).value_or(0.0f) };
+    }
+    else if (type_name == "int")
+    {
+        return tpp::CustomProperty { tpp::detail::parseInt(val).value_or(0) };
+    }
+    else
+    {
+        tpp::Error err { "[Custom Property] Unknown or unimplemented attribute type found" };
+        return tl::make_unexpected(err);
+    }
+}
+
 tpp::Result<std::pair<std::string, tpp::CustomProperty>> parseCustomProperty(const rapidxml::xml_node<char>* prop_node)
 {
     auto* name_attrib = prop_node->first_attribute("name");
@@ -15,68 +89,198 @@ tpp::Result<std::pair<std::string, tpp::CustomProperty>> parseCustomProperty(con
         return tl::make_unexpected(err);
     }
 
-    std::string name = name_attrib->value();
-    std::string val = val_attrib->value();
-
+    std::string_view type_name {};
     if (auto type = prop_node->first_attribute("type"))
     {
-        auto type_name = std::string(type->value());
+        type_name = type->value();
+    }
+
+    auto result = parseCustomProperty(type_name, val_attrib->value());
+    if (!result)
+    {
+        return tl::make_unexpected(result.error());
+    }
+
+    return std::make_pair(std::string(name_attrib->value()), std::move(result.value()));
+}
 
-        if (type_name == "bool")
+tpp::Result<tpp::PropertyMap> tpp::PropertyMap::fromNode(const rapidxml::xml_node<char>* node)
+{
+    PropertyMap out {};
+
+    for (auto prop = node->first_node("property"); prop != nullptr; prop = prop->next_sibling("property"))
+    {
+        auto result = parseCustomProperty(prop);
+
+        // TODO: logging or warning propagation
+        if (result)
         {
-            if (val == "true")
-            {
-                return std::make_pair(name, tpp::CustomProperty { true });
-            }
-            else
-            {
-                return std::make_pair(name, tpp::CustomProperty { false });
-            }
+            out.set(Name(result.value().first), std::move(result.value().second.value));
         }
-        else if (type_name == "color")
+    }
+
+    return out;
+}
+
+tpp::Result<tpp::PropertyMap> tpp::PropertyMap::fromReader(detail::XmlReader& reader, const detail::XmlTag& properties_tag, std::pmr::memory_resource* resource, StringStore* retained, bool strict)
+{
+    using detail::XmlAttribute;
+
+    PropertyMap out { resource };
+    std::optional<Error> error {};
+
+    if (properties_tag.is_empty)
+    {
+        return out;
+    }
+
+    // Only the first error is kept, the remaining properties are still consumed so the reader stays in place
+    auto fail = [&](const char* message)
+    {
+        if (strict && !error)
         {
-            std::string_view view = val;
-            view.remove_prefix(1);
+            error = Error { std::string("[Custom Property] ") + message };
+        }
+    };
 
-            auto hex = tpp::detail::parseHex(view).value_or(0xff000000);
+    detail::XmlTag prop {};
+    while (reader.nextChild(prop))
+    {
+        if (prop.element != detail::XmlElement::Property)
+        {
+            reader.skip(prop);
+            continue;
+        }
+
+        std::string_view type_name = prop.get(XmlAttribute::Type);
 
-            tpp::Pixel colour { hex };
-            return std::make_pair(name, tpp::CustomProperty { colour });
+        // Class members are nested <properties>, which are not supported
+        if (type_name == "class")
+        {
+            reader.skip(prop);
+            continue;
         }
-        else if (type_name == "float")
+
+        // Object references are stored as the object id
+        if (type_name == "object")
         {
-            return std::make_pair(name, tpp::CustomProperty { tpp::detail::parseFloat(val).value_or(0.0f) });
+            type_name = "int";
         }
-        else if (type_name == "int")
+
+        if (!prop.has(XmlAttribute::Name))
         {
-            return std::make_pair(name, tpp::CustomProperty { tpp::detail::parseInt(val).value_or(0) });
+            fail("missing attribute 'name' in <property>");
+            reader.skip(prop);
+            continue;
+        }
+
+        // Multi line strings are written as the text of the tag instead of a value attribute
+        std::string_view raw_value {};
+        if (prop.has(XmlAttribute::Value))
+        {
+            raw_value = prop.get(XmlAttribute::Value);
+            reader.skip(prop);
+        }
+        else if (isStringType(type_name) && !prop.is_empty)
+        {
+            raw_value = reader.readText(prop);
         }
         else
         {
-            tpp::Error err { "[Custom Property] Unknown or unimplemented attribute type found" };
-            return tl::make_unexpected(err);
+            fail("missing attribute 'value' in <property>");
+            reader.skip(prop);
+            continue;
+        }
+
+        if (strict && !isValidValue(type_name, raw_value))
+        {
+            fail(isKnownType(type_name) ? "invalid property value" : "unknown property type");
+            continue;
+        }
+
+        // Retained strings point into the source text instead of being copied
+        auto result = retained && isStringType(type_name)
+            ? Result<CustomProperty>(CustomProperty { retained->decode(raw_value) })
+            : parseCustomProperty(type_name, detail::decodeEntities(raw_value));
+
+        if (result)
+        {
+            std::string_view raw_name = prop.get(XmlAttribute::Name);
+
+            // Names without entities are interned straight from the source text
+            Name name = raw_name.find('&') == std::string_view::npos
+                ? Name(raw_name)
+                : Name(detail::decodeEntities(raw_name));
+
+            out.insert(name) = std::move(result.value());
         }
     }
-    else
+
+    if (error)
     {
-        return std::make_pair(name, tpp::CustomProperty { val });
+        return tl::make_unexpected(std::move(*error));
     }
+
+    return out;
 }
 
-tpp::Result<tpp::PropertyMap> tpp::PropertyMap::fromNode(const rapidxml::xml_node<char>* node)
+tpp::CustomProperty& tpp::PropertyMap::insert(Name key)
 {
-    PropertyMap out {};
+    // Grow before probing, so the probe always ends at a free slot
+    if ((count + 1) * 4 > slots.size() * 3)
+    {
+        grow();
+    }
 
-    for (auto prop = node->first_node("property"); prop != nullptr; prop = prop->next_sibling("property"))
+    Slot& slot = slots[probe(key.hash(), [key](Name name)
+        { return name == key; })];
+
+    if (!slot.key.isValid())
     {
-        auto result = parseCustomProperty(prop);
+        slot.key = key;
+        ++count;
+    }
+    return slot.property;
+}
 
-        // TODO: logging or warning propagation
-        if (result)
+void tpp::PropertyMap::erase(size_t index)
+{
+    if (index == NOT_FOUND)
+    {
+        return;
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t hole = index;
+
+    // Backward shift: move every key of the probe run that would not be found anymore into the hole
+    for (size_t i = (hole + 1) & mask; slots[i].key.isValid(); i = (i + 1) & mask)
+    {
+        size_t home = slots[i].key.hash() & mask;
+
+        if (((i - home) & mask) >= ((i - hole) & mask))
         {
-            out.data.emplace(result.value());
+            slots[hole] = std::move(slots[i]);
+            hole = i;
         }
     }
 
-    return out;
-}
\ No newline at end of file
+    slots[hole] = Slot {};
+    --count;
+}
+
+void tpp::PropertyMap::grow()
+{
+    std::pmr::vector<Slot> old(slots.size() == 0 ? 8 : slots.size() * 2, slots.get_allocator());
+    old.swap(slots);
+
+    for (Slot& slot : old)
+    {
+        if (slot.key.isValid())
+        {
+            Slot& free_slot = slots[probe(slot.key.hash(), [](Name)
+                { return false; })];
+            free_slot = std::move(slot);
+        }
+    }
+}
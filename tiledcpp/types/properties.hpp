@@ -1,10 +1,17 @@
 #pragma once
 #include "tiledcpp/config.hpp"
 
+#include <cstddef>
+#include <memory_resource>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <variant>
+#include <vector>
 
 #include "tiledcpp/types/math.hpp"
+#include "tiledcpp/types/name.hpp"
 #include "tiledcpp/types/result.hpp"
 
 namespace rapidxml
@@ -13,73 +20,254 @@ template <typename T>
 class xml_node;
 }
 
+namespace tpp::detail
+{
+class XmlReader;
+struct XmlTag;
+}
+
 namespace tpp
 {
 
+class StringStore;
+
 struct TILEDCPP_API CustomProperty
 {
-    std::variant<std::monostate, bool, int, float, std::string, Pixel> value;
+    // String values are std::string_view when loaded with LoadOptions::retain_source, pointing into the source
+    // text kept by the map or tileset. Both string types can be read as either std::string or std::string_view
+    std::variant<std::monostate, bool, int, float, std::string, Pixel, std::string_view> value;
 };
 
 // Map for custom properties that tiles, maps, layers and tilesets can contain.
-// Supported custom properties: bool, int, float, string and colours (tpp::Pixel)
+// Supported custom properties: bool, int, float, string and colours (tpp::Pixel).
+// Open addressing hash table keyed by interned Names: lookups with a Name only compare pointers,
+// lookups with a Key (hashed at compile time) or a string compare the text of the keys with the same hash
 class TILEDCPP_API PropertyMap
 {
 public:
     // Create a property map from an xml node, following the Tiled format spec
     static Result<PropertyMap> fromNode(const rapidxml::xml_node<char>* property_node);
 
+    // Create a property map from the <properties> tag the reader is currently at, consuming all of its children
+    // The table is allocated from resource, e.g. an arena the whole map is loaded into
+    // If retained is set, string values are views decoded in place in its retained source text
+    // Malformed properties and unknown types are skipped, unless strict is set: then the first one is returned as an error
+    static Result<PropertyMap> fromReader(detail::XmlReader& reader, const detail::XmlTag& properties_tag,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(), StringStore* retained = nullptr, bool strict = false);
+
+    // Allocator aware, so pmr containers of PropertyMaps pass their memory resource on
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    PropertyMap() = default;
+    explicit PropertyMap(const allocator_type& allocator)
+        : slots(allocator)
+    {
+    }
+
+    PropertyMap(const PropertyMap& other, const allocator_type& allocator)
+        : slots(other.slots, allocator)
+        , count(other.count)
+    {
+    }
+
+    // Moved from maps are left empty, and can still be used
+    PropertyMap(PropertyMap&& other, const allocator_type& allocator)
+        : slots(std::move(other.slots), allocator)
+        , count(other.count)
+    {
+        other.clear();
+    }
+
+    PropertyMap(PropertyMap&& other) noexcept
+        : slots(std::move(other.slots))
+        , count(other.count)
+    {
+        other.clear();
+    }
+
+    PropertyMap& operator=(PropertyMap&& other)
+    {
+        if (this != &other)
+        {
+            slots = std::move(other.slots);
+            count = other.count;
+            other.clear();
+        }
+        return *this;
+    }
+
+    PropertyMap(const PropertyMap&) = default;
+    PropertyMap& operator=(const PropertyMap&) = default;
+
+    allocator_type get_allocator() const { return slots.get_allocator(); }
+
     // Checks if a key exists with the given type and name
     template <typename T>
-    bool has(const std::string& key) const;
+    bool has(std::string_view key) const { return holds<T>(find(key)); }
+
+    template <typename T>
+    bool has(Name key) const { return holds<T>(find(key)); }
+
+    template <typename T>
+    bool has(Key key) const { return holds<T>(find(key)); }
 
     // Sets value with type and key. Will overwrite another value with same key but different type.
     template <typename T>
-    void set(const std::string& key, const T& value);
+    void set(std::string_view key, const T& value) { insert(Name(key)).value = value; }
+
+    template <typename T>
+    void set(Name key, const T& value) { insert(key).value = value; }
 
     // Remove a value with key
-    void remove(const std::string& key);
+    void remove(std::string_view key) { erase(indexOf(key)); }
+    void remove(Name key) { erase(indexOf(key)); }
 
     // Returns the value with the given key and name. Returns null optional if either type or name is missing
     template <typename T>
-    std::optional<T> get(const std::string& key) const;
+    std::optional<T> get(std::string_view key) const { return read<T>(find(key)); }
 
-    size_t size() const { return data.size(); }
+    template <typename T>
+    std::optional<T> get(Name key) const { return read<T>(find(key)); }
+
+    template <typename T>
+    std::optional<T> get(Key key) const { return read<T>(find(key)); }
+
+    size_t size() const { return count; }
+
+    // Removes every property
+    void clear()
+    {
+        slots.clear();
+        count = 0;
+    }
+
+    // Calls fn(name, property) for every property, in no particular order
+    template <typename F>
+    void forEach(F&& fn) const;
 
 private:
-    std::unordered_map<std::string, CustomProperty> data;
+    struct Slot
+    {
+        // Invalid for free slots
+        Name key {};
+        CustomProperty property {};
+    };
+
+    template <typename T>
+    static constexpr bool IS_STRING = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+    template <typename T>
+    static bool holds(const CustomProperty* property);
+
+    template <typename T>
+    static std::optional<T> read(const CustomProperty* property);
+
+    // Index of the slot holding the key matching hash and is_key, or of the free slot ending the probe.
+    // The table must not be empty
+    template <typename F>
+    size_t probe(uint32_t hash, F&& is_key) const;
+
+    // Index of the slot holding key, NOT_FOUND if missing
+    static constexpr size_t NOT_FOUND = ~size_t(0);
+    size_t indexOf(Name key) const;
+    size_t indexOf(Key key) const;
+    size_t indexOf(std::string_view key) const { return indexOf(Key(key)); }
+
+    template <typename K>
+    const CustomProperty* find(K key) const
+    {
+        size_t index = indexOf(key);
+        return index == NOT_FOUND ? nullptr : &slots[index].property;
+    }
+
+    // Returns the property of key, adding an empty one if needed
+    CustomProperty& insert(Name key);
+    // Removes the slot at index, shifting back the keys probed past it. Does nothing with NOT_FOUND
+    void erase(size_t index);
+    void grow();
+
+    // Power of 2 size, at most 3/4 full
+    std::pmr::vector<Slot> slots {};
+    size_t count = 0;
 };
 
 template <typename T>
-bool PropertyMap::has(const std::string& key) const
+bool PropertyMap::holds(const CustomProperty* property)
 {
-    auto it = data.find(key);
-    return it != data.end() && std::holds_alternative<T>(it->second.value);
+    if (property == nullptr)
+        return false;
+
+    if constexpr (IS_STRING<T>)
+        return std::holds_alternative<std::string>(property->value) || std::holds_alternative<std::string_view>(property->value);
+    else
+        return std::holds_alternative<T>(property->value);
 }
 
 template <typename T>
-std::optional<T> PropertyMap::get(const std::string& key) const
+std::optional<T> PropertyMap::read(const CustomProperty* property)
 {
-
-    auto it = data.find(key);
-    if (it == data.end())
+    if (!holds<T>(property))
         return std::nullopt;
 
-    const auto& var = it->second.value;
-    if (!std::holds_alternative<T>(it->second.value))
-        return std::nullopt;
+    const auto& var = property->value;
 
-    return std::get<T>(var);
+    if constexpr (IS_STRING<T>)
+    {
+        if (auto* owned = std::get_if<std::string>(&var))
+            return T(*owned);
+        return T(std::get<std::string_view>(var));
+    }
+    else
+    {
+        return std::get<T>(var);
+    }
 }
 
-template <typename T>
-void PropertyMap::set(const std::string& key, const T& value)
+template <typename F>
+size_t PropertyMap::probe(uint32_t hash, F&& is_key) const
 {
-    data[key].value = value;
+    size_t mask = slots.size() - 1;
+    size_t index = hash & mask;
+
+    while (slots[index].key.isValid() && !is_key(slots[index].key))
+    {
+        index = (index + 1) & mask;
+    }
+    return index;
 }
 
-inline void PropertyMap::remove(const std::string& key)
+inline size_t PropertyMap::indexOf(Name key) const
 {
-    data.erase(key);
+    if (count == 0 || !key.isValid())
+        return NOT_FOUND;
+
+    size_t index = probe(key.hash(), [key](Name name)
+        { return name == key; });
+
+    return slots[index].key.isValid() ? index : NOT_FOUND;
+}
+
+inline size_t PropertyMap::indexOf(Key key) const
+{
+    if (count == 0)
+        return NOT_FOUND;
+
+    size_t index = probe(key.hash(), [key](Name name)
+        { return name.hash() == key.hash() && name.str() == key.str(); });
+
+    return slots[index].key.isValid() ? index : NOT_FOUND;
+}
+
+template <typename F>
+void PropertyMap::forEach(F&& fn) const
+{
+    for (const Slot& slot : slots)
+    {
+        if (slot.key.isValid())
+        {
+            fn(slot.key, slot.property);
+        }
+    }
+}
+
 }
-}
\ No newline at end of file
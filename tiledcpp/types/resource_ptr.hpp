@@ -0,0 +1,45 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace tpp
+{
+
+// Deletes objects created by allocateUnique()
+template <typename T>
+struct ResourceDelete
+{
+    std::pmr::memory_resource* resource {};
+
+    void operator()(T* ptr) const
+    {
+        ptr->~T();
+        resource->deallocate(ptr, sizeof(T), alignof(T));
+    }
+};
+
+// Owning pointer to an object allocated from a memory resource
+template <typename T>
+using ResourcePtr = std::unique_ptr<T, ResourceDelete<T>>;
+
+// Constructs a T from args in memory taken from resource
+template <typename T, typename... Args>
+ResourcePtr<T> allocateUnique(std::pmr::memory_resource* resource, Args&&... args)
+{
+    void* memory = resource->allocate(sizeof(T), alignof(T));
+    try
+    {
+        return ResourcePtr<T>(new (memory) T(std::forward<Args>(args)...), ResourceDelete<T> { resource });
+    }
+    catch (...)
+    {
+        resource->deallocate(memory, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+}
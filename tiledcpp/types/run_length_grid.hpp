@@ -0,0 +1,140 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/types/math.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace tpp
+{
+
+// Fixed size 2D grid that stores every row as runs of equal values.
+// Meant for layers with long horizontal stretches of the same value, like mostly empty or filled layers.
+// Same read interface as Array2D and SparseGrid, but read only once built
+template <typename T>
+class RunLengthGrid
+{
+public:
+    // A run covers from start to the start of the next run in the same row (or the end of the row)
+    struct Run
+    {
+        uint32_t start {};
+        T value {};
+    };
+
+    RunLengthGrid() = default;
+
+    // Builds the grid from size.x * size.y values in row major order
+    template <typename Iterator>
+    static RunLengthGrid fromRowMajor(const UVec2& size, Iterator values);
+
+    T at(uint32_t x, uint32_t y) const;
+    T at(const UVec2& xy) const { return at(xy.x, xy.y); }
+
+    UVec2 size() const { return grid_size; }
+
+    // Writes the size().x values of row y to out
+    void copyRow(uint32_t y, T* out) const;
+
+    // Calls fn(x, y, value) for every value that is not equal to T {}, in row major order
+    template <typename F>
+    void forEachNonEmpty(F&& fn) const;
+
+    size_t getRunCount() const { return runs.size(); }
+
+private:
+    UVec2 grid_size {};
+    std::vector<Run> runs {};
+
+    // Index of the first run of every row, plus one past the last run
+    std::vector<size_t> row_offsets {};
+};
+
+template <typename T>
+template <typename Iterator>
+RunLengthGrid<T> RunLengthGrid<T>::fromRowMajor(const UVec2& size, Iterator values)
+{
+    RunLengthGrid out {};
+    out.grid_size = size;
+    out.row_offsets.reserve(static_cast<size_t>(size.y) + 1);
+
+    for (uint32_t y = 0; y < size.y; ++y)
+    {
+        out.row_offsets.emplace_back(out.runs.size());
+
+        for (uint32_t x = 0; x < size.x; ++x, ++values)
+        {
+            T value = T(*values);
+
+            if (x == 0 || !(out.runs.back().value == value))
+            {
+                out.runs.push_back(Run { x, value });
+            }
+        }
+    }
+
+    out.row_offsets.emplace_back(out.runs.size());
+    out.runs.shrink_to_fit();
+    return out;
+}
+
+template <typename T>
+T RunLengthGrid<T>::at(uint32_t x, uint32_t y) const
+{
+    if (x >= grid_size.x || y >= grid_size.y)
+    {
+        throw std::out_of_range("RunLengthGrid index out of bounds");
+    }
+
+    auto begin = runs.begin() + row_offsets[y];
+    auto end = runs.begin() + row_offsets[y + 1];
+
+    // Last run starting at or before x
+    auto it = std::upper_bound(begin, end, x, [](uint32_t value, const Run& run)
+        { return value < run.start; });
+
+    return std::prev(it)->value;
+}
+
+template <typename T>
+void RunLengthGrid<T>::copyRow(uint32_t y, T* out) const
+{
+    if (y >= grid_size.y)
+    {
+        throw std::out_of_range("RunLengthGrid row out of bounds");
+    }
+
+    for (size_t i = row_offsets[y]; i < row_offsets[y + 1]; ++i)
+    {
+        uint32_t end = i + 1 < row_offsets[y + 1] ? runs[i + 1].start : grid_size.x;
+        std::fill(out + runs[i].start, out + end, runs[i].value);
+    }
+}
+
+template <typename T>
+template <typename F>
+void RunLengthGrid<T>::forEachNonEmpty(F&& fn) const
+{
+    const T empty {};
+
+    for (uint32_t y = 0; y < grid_size.y; ++y)
+    {
+        for (size_t i = row_offsets[y]; i < row_offsets[y + 1]; ++i)
+        {
+            if (runs[i].value == empty)
+            {
+                continue;
+            }
+
+            uint32_t end = i + 1 < row_offsets[y + 1] ? runs[i + 1].start : grid_size.x;
+            for (uint32_t x = runs[i].start; x < end; ++x)
+            {
+                fn(x, y, runs[i].value);
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace tpp
+{
+
+// Non owning view over contiguous elements, a minimal std::span for C++17
+template <typename T>
+class Span
+{
+public:
+    Span() = default;
+    Span(T* data, size_t size)
+        : ptr(data)
+        , count(size)
+    {
+    }
+
+    T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Unchecked
+    T& operator[](size_t i) const { return ptr[i]; }
+
+    T& at(size_t i) const
+    {
+        if (i >= count)
+        {
+            throw std::out_of_range("Span index out of bounds");
+        }
+        return ptr[i];
+    }
+
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + count; }
+
+private:
+    T* ptr {};
+    size_t count {};
+};
+
+}
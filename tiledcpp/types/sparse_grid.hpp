@@ -0,0 +1,214 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include "tiledcpp/types/math.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace tpp
+{
+
+// Fixed size 2D grid split in square chunks, where only chunks with at least one non empty value (not equal to T {}) are allocated.
+// Meant for layers where most of the map is empty, e.g. decorations or collision.
+// Same read interface as Array2D and RunLengthGrid, but read only once built
+template <typename T, uint32_t CHUNK_SIZE = 16>
+class SparseGrid
+{
+public:
+    SparseGrid() = default;
+
+    // Builds the grid from size.x * size.y values in row major order
+    template <typename Iterator>
+    static SparseGrid fromRowMajor(const UVec2& size, Iterator values);
+
+    // Builds the grid from (UVec2 position, value) pairs, without visiting the cells that are not listed.
+    // Unlisted cells are empty and later pairs overwrite earlier ones. Throws std::out_of_range for positions outside the grid
+    template <typename Iterator>
+    static SparseGrid fromCells(const UVec2& size, Iterator first, Iterator last);
+
+    T at(uint32_t x, uint32_t y) const;
+    T at(const UVec2& xy) const { return at(xy.x, xy.y); }
+
+    UVec2 size() const { return grid_size; }
+
+    // Writes the size().x values of row y to out
+    void copyRow(uint32_t y, T* out) const;
+
+    // Calls fn(x, y, value) for every value that is not equal to T {}, in row major order
+    template <typename F>
+    void forEachNonEmpty(F&& fn) const;
+
+    size_t getChunkCount() const { return chunks.size() / CHUNK_CELLS; }
+
+private:
+    static constexpr uint32_t CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+    static constexpr uint32_t EMPTY_CHUNK = 0xFFFFFFFF;
+
+    explicit SparseGrid(const UVec2& size);
+
+    const T* findChunk(uint32_t chunk_x, uint32_t chunk_y) const;
+
+    // Stores a non empty value, allocating its chunk if needed
+    void set(uint32_t x, uint32_t y, const T& value);
+
+    UVec2 grid_size {};
+    UVec2 chunk_grid_size {};
+
+    // For every chunk, its index in chunks (in units of CHUNK_CELLS) or EMPTY_CHUNK
+    std::vector<uint32_t> chunk_table {};
+
+    // Values of all allocated chunks, row major inside each chunk
+    std::vector<T> chunks {};
+};
+
+template <typename T, uint32_t CHUNK_SIZE>
+SparseGrid<T, CHUNK_SIZE>::SparseGrid(const UVec2& size)
+    : grid_size(size)
+    , chunk_grid_size(static_cast<uint32_t>((uint64_t(size.x) + CHUNK_SIZE - 1) / CHUNK_SIZE),
+          static_cast<uint32_t>((uint64_t(size.y) + CHUNK_SIZE - 1) / CHUNK_SIZE))
+    , chunk_table(static_cast<size_t>(chunk_grid_size.x) * chunk_grid_size.y, EMPTY_CHUNK)
+{
+}
+
+template <typename T, uint32_t CHUNK_SIZE>
+template <typename Iterator>
+SparseGrid<T, CHUNK_SIZE> SparseGrid<T, CHUNK_SIZE>::fromRowMajor(const UVec2& size, Iterator values)
+{
+    SparseGrid out { size };
+
+    const T empty {};
+
+    for (uint32_t y = 0; y < size.y; ++y)
+    {
+        for (uint32_t x = 0; x < size.x; ++x, ++values)
+        {
+            T value = T(*values);
+            if (!(value == empty))
+            {
+                out.set(x, y, value);
+            }
+        }
+    }
+
+    out.chunks.shrink_to_fit();
+    return out;
+}
+
+template <typename T, uint32_t CHUNK_SIZE>
+template <typename Iterator>
+SparseGrid<T, CHUNK_SIZE> SparseGrid<T, CHUNK_SIZE>::fromCells(const UVec2& size, Iterator first, Iterator last)
+{
+    SparseGrid out { size };
+
+    const T empty {};
+
+    for (; first != last; ++first)
+    {
+        const auto& [position, cell_value] = *first;
+        if (position.x >= size.x || position.y >= size.y)
+        {
+            throw std::out_of_range("SparseGrid cell out of bounds");
+        }
+
+        // Empty values only need storing to clear a cell set by an earlier pair
+        T value = T(cell_value);
+        if (!(value == empty) || out.findChunk(position.x / CHUNK_SIZE, position.y / CHUNK_SIZE) != nullptr)
+        {
+            out.set(position.x, position.y, value);
+        }
+    }
+
+    out.chunks.shrink_to_fit();
+    return out;
+}
+
+template <typename T, uint32_t CHUNK_SIZE>
+void SparseGrid<T, CHUNK_SIZE>::set(uint32_t x, uint32_t y, const T& value)
+{
+    uint32_t& chunk = chunk_table[static_cast<size_t>(y / CHUNK_SIZE) * chunk_grid_size.x + x / CHUNK_SIZE];
+    if (chunk == EMPTY_CHUNK)
+    {
+        chunk = static_cast<uint32_t>(chunks.size() / CHUNK_CELLS);
+        chunks.resize(chunks.size() + CHUNK_CELLS, T {});
+    }
+
+    chunks[static_cast<size_t>(chunk) * CHUNK_CELLS + (y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE] = value;
+}
+
+template <typename T, uint32_t CHUNK_SIZE>
+const T* SparseGrid<T, CHUNK_SIZE>::findChunk(uint32_t chunk_x, uint32_t chunk_y) const
+{
+    uint32_t chunk = chunk_table[static_cast<size_t>(chunk_y) * chunk_grid_size.x + chunk_x];
+    return chunk == EMPTY_CHUNK ? nullptr : &chunks[static_cast<size_t>(chunk) * CHUNK_CELLS];
+}
+
+template <typename T, uint32_t CHUNK_SIZE>
+T SparseGrid<T, CHUNK_SIZE>::at(uint32_t x, uint32_t y) const
+{
+    if (x >= grid_size.x || y >= grid_size.y)
+    {
+        throw std::out_of_range("SparseGrid index out of bounds");
+    }
+
+    const T* chunk = findChunk(x / CHUNK_SIZE, y / CHUNK_SIZE);
+    return chunk ? chunk[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE] : T {};
+}
+
+template <typename T, uint32_t CHUNK_SIZE>
+void SparseGrid<T, CHUNK_SIZE>::copyRow(uint32_t y, T* out) const
+{
+    if (y >= grid_size.y)
+    {
+        throw std::out_of_range("SparseGrid row out of bounds");
+    }
+
+    for (uint32_t chunk_x = 0; chunk_x < chunk_grid_size.x; ++chunk_x)
+    {
+        uint32_t start = chunk_x * CHUNK_SIZE;
+        uint32_t count = std::min(CHUNK_SIZE, grid_size.x - start);
+
+        if (const T* chunk = findChunk(chunk_x, y / CHUNK_SIZE))
+        {
+            std::copy_n(chunk + (y % CHUNK_SIZE) * CHUNK_SIZE, count, out + start);
+        }
+        else
+        {
+            std::fill_n(out + start, count, T {});
+        }
+    }
+}
+
+template <typename T, uint32_t CHUNK_SIZE>
+template <typename F>
+void SparseGrid<T, CHUNK_SIZE>::forEachNonEmpty(F&& fn) const
+{
+    const T empty {};
+
+    for (uint32_t y = 0; y < grid_size.y; ++y)
+    {
+        for (uint32_t chunk_x = 0; chunk_x < chunk_grid_size.x; ++chunk_x)
+        {
+            const T* chunk = findChunk(chunk_x, y / CHUNK_SIZE);
+            if (chunk == nullptr)
+            {
+                continue;
+            }
+
+            const T* row = chunk + (y % CHUNK_SIZE) * CHUNK_SIZE;
+            uint32_t start = chunk_x * CHUNK_SIZE;
+            uint32_t count = std::min(CHUNK_SIZE, grid_size.x - start);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (!(row[i] == empty))
+                {
+                    fn(start + i, y, row[i]);
+                }
+            }
+        }
+    }
+}
+
+}
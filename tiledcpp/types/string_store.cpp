@@ -0,0 +1,51 @@
+#include "tiledcpp/types/string_store.hpp"
+#include "tiledcpp/detail/xml_reader.hpp"
+
+#include <cstring>
+#include <functional>
+
+tpp::StringStore::StringStore(std::pmr::memory_resource* upstream)
+    : arena(upstream)
+{
+}
+
+std::string_view tpp::StringStore::retainSource(std::string&& text)
+{
+    source = std::move(text);
+    return source;
+}
+
+bool tpp::StringStore::isRetained(std::string_view text) const
+{
+    std::less_equal<const char*> less_equal {};
+    return !source.empty() && less_equal(source.data(), text.data()) && less_equal(text.data() + text.size(), source.data() + source.size());
+}
+
+std::string_view tpp::StringStore::decode(std::string_view raw)
+{
+    if (raw.empty())
+    {
+        return {};
+    }
+
+    if (isRetained(raw) && raw.find('&') == std::string_view::npos)
+    {
+        return raw;
+    }
+
+    // Decoding never makes the text longer
+    char* out = static_cast<char*>(arena.allocate(raw.size(), 1));
+    return std::string_view(out, detail::decodeEntities(raw, out));
+}
+
+std::string_view tpp::StringStore::copy(std::string_view text)
+{
+    if (text.empty())
+    {
+        return {};
+    }
+
+    char* out = static_cast<char*>(arena.allocate(text.size(), 1));
+    std::memcpy(out, text.data(), text.size());
+    return std::string_view(out, text.size());
+}
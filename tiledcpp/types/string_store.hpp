@@ -0,0 +1,41 @@
+#pragma once
+#include "tiledcpp/config.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace tpp
+{
+
+// Owns the text that the string properties of a map or tileset point into, when loading with LoadOptions::retain_source.
+// Stored text never moves, so string_views into it stay valid for the lifetime of the store
+class TILEDCPP_API StringStore
+{
+public:
+    explicit StringStore(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    // Non copyable, non movable
+    StringStore(const StringStore&) = delete;
+    StringStore& operator=(const StringStore&) = delete;
+
+    // Keeps the source text of a file alive, so that strings can point into it instead of being copied.
+    // Parse the returned text, not the one passed in
+    std::string_view retainSource(std::string&& text);
+    std::string_view getSource() const { return source; }
+
+    // Returns raw with its XML entities decoded. Text inside the retained source without any entity is returned as is,
+    // anything else is decoded into the store. The retained source is never modified
+    std::string_view decode(std::string_view raw);
+
+    // Copies text into the store
+    std::string_view copy(std::string_view text);
+
+private:
+    bool isRetained(std::string_view text) const;
+
+    std::string source {};
+    std::pmr::monotonic_buffer_resource arena;
+};
+
+}
@@ -0,0 +1,154 @@
+#include "benchmark.hpp"
+#include "support/counting_resource.hpp"
+
+#include <tiledcpp/tiledcpp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <memory_resource>
+#include <new>
+
+namespace
+{
+
+// Every heap allocation made by the benchmarks goes through the replaced operator new below
+std::atomic<size_t> heap_allocations { 0 };
+
+}
+
+void* operator new(size_t size)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// std::pmr::new_delete_resource() uses the aligned overloads
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+#if defined(_MSC_VER)
+    void* ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, align, size == 0 ? 1 : size) != 0)
+    {
+        ptr = nullptr;
+    }
+#endif
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(ptr, alignment);
+}
+
+void bench::runAllocationBenchmarks()
+{
+    std::printf("\n[Allocations]\n");
+
+    auto tileset_path = generateTileSet("bench_tileset", 10000);
+    auto map_path = generateMap("bench_alloc_map", "bench_tileset.tsx", 10000, 64, 16, 50);
+
+    tpp::LoadOptions options {};
+    options.load_images = false;
+
+    // Load and destroy the map, counting heap allocations and blocks taken by the arena
+    auto count = [&](const char* name, bool use_arena, bool retain_source)
+    {
+        test_support::CountingResource upstream_counter { std::pmr::new_delete_resource() };
+        std::pmr::monotonic_buffer_resource arena { &upstream_counter };
+
+        tpp::LoadOptions arena_options = options;
+        arena_options.retain_source = retain_source;
+        if (use_arena)
+        {
+            arena_options.memory_resource = &arena;
+        }
+
+        size_t before = heap_allocations.load();
+        {
+            auto map = tpp::TileMap::fromTMX(map_path, arena_options);
+            if (!map)
+            {
+                std::printf("%s\n", map.error().message.c_str());
+            }
+            doNotOptimize(map);
+        }
+        size_t total = heap_allocations.load() - before;
+
+        std::printf("%-48s %12zu allocations (%zu arena blocks)\n", name, total, upstream_counter.allocations);
+    };
+
+    count("TileMap 64x64, 16 layers, 10k tiles (heap)", false, false);
+    count("TileMap 64x64, 16 layers, 10k tiles (arena)", true, false);
+    count("TileMap 64x64, 16 layers (arena, retained)", true, true);
+
+    // Scratch allocations left once a Loader has warmed up, with the results in an arena
+    {
+        tpp::LoadOptions arena_options = options;
+        tpp::Loader loader { arena_options };
+        doNotOptimize(loader.loadMap(map_path));
+
+        std::pmr::monotonic_buffer_resource arena {};
+        arena_options.memory_resource = &arena;
+        loader.setOptions(arena_options);
+
+        size_t before = heap_allocations.load();
+        {
+            auto map = loader.loadMap(map_path);
+            doNotOptimize(map);
+        }
+        std::printf("%-48s %12zu allocations\n", "TileMap 64x64, 16 layers (Loader + arena)", heap_allocations.load() - before);
+    }
+
+    run("Load + free (heap)", 10, [&]()
+        { doNotOptimize(tpp::TileMap::fromTMX(map_path, options)); });
+
+    run("Load + free (monotonic arena)", 10, [&]()
+        {
+            std::pmr::monotonic_buffer_resource arena {};
+            tpp::LoadOptions arena_options = options;
+            arena_options.memory_resource = &arena;
+            doNotOptimize(tpp::TileMap::fromTMX(map_path, arena_options)); });
+
+    tpp::Loader loader { options };
+    run("Load + free (Loader + monotonic arena)", 10, [&]()
+        {
+            std::pmr::monotonic_buffer_resource arena {};
+            tpp::LoadOptions arena_options = options;
+            arena_options.memory_resource = &arena;
+            loader.setOptions(arena_options);
+            doNotOptimize(loader.loadMap(map_path)); });
+}
@@ -0,0 +1,230 @@
+#include "benchmark.hpp"
+
+#include <tiledcpp/parallel.hpp>
+#include <tiledcpp/types/array2d.hpp>
+
+namespace
+{
+
+constexpr uint32_t GRID_SIZE = 2048;
+
+template <typename Layout>
+void runRegionScans(const std::string& layout_name)
+{
+    tpp::Array2D<uint32_t, Layout> grid(GRID_SIZE, GRID_SIZE);
+
+    uint32_t value = 0;
+    for (auto& cell : grid)
+    {
+        cell = value++;
+    }
+
+    // Random square regions, summed through at() like a collision or visibility query would
+    for (uint32_t region : { 8u, 32u, 128u })
+    {
+        bench::run("Region scans " + std::to_string(region) + "x" + std::to_string(region) + " (" + layout_name + ")", 10, [&]()
+            {
+                uint32_t state = 1;
+                uint64_t sum = 0;
+                uint32_t queries = (1u << 22) / (region * region);
+
+                for (uint32_t i = 0; i < queries; ++i)
+                {
+                    state = state * 1664525u + 1013904223u;
+                    uint32_t start_x = (state >> 4) % (GRID_SIZE - region);
+                    state = state * 1664525u + 1013904223u;
+                    uint32_t start_y = (state >> 4) % (GRID_SIZE - region);
+
+                    for (uint32_t y = start_y; y < start_y + region; ++y)
+                    {
+                        for (uint32_t x = start_x; x < start_x + region; ++x)
+                        {
+                            sum += grid.at(x, y);
+                        }
+                    }
+                }
+                bench::doNotOptimize(sum); });
+    }
+
+    // Column sweep, the worst case for row major storage
+    bench::run("Column sweeps (" + layout_name + ")", 10, [&]()
+        {
+            uint64_t sum = 0;
+            for (uint32_t x = 0; x < GRID_SIZE; ++x)
+            {
+                for (uint32_t y = 0; y < GRID_SIZE; ++y)
+                {
+                    sum += grid.at(x, y);
+                }
+            }
+            bench::doNotOptimize(sum); });
+
+    bench::run("Full iteration (" + layout_name + ")", 10, [&]()
+        {
+            uint64_t sum = 0;
+            for (uint32_t cell : grid)
+            {
+                sum += cell;
+            }
+            bench::doNotOptimize(sum); });
+}
+
+}
+
+void bench::runArray2DBenchmarks()
+{
+    std::printf("\n[Array2D Layouts, %ux%u]\n", GRID_SIZE, GRID_SIZE);
+
+    runRegionScans<tpp::RowMajorLayout>("row major");
+
+    tpp::Array2D<uint32_t> grid(GRID_SIZE, GRID_SIZE, 1);
+
+    run("Full scan, checked at()", 10, [&]()
+        {
+            uint64_t sum = 0;
+            for (uint32_t y = 0; y < GRID_SIZE; ++y)
+            {
+                for (uint32_t x = 0; x < GRID_SIZE; ++x)
+                {
+                    sum += grid.at(x, y);
+                }
+            }
+            doNotOptimize(sum); });
+
+    run("Full scan, row spans", 10, [&]()
+        {
+            uint64_t sum = 0;
+            for (uint32_t y = 0; y < GRID_SIZE; ++y)
+            {
+                for (uint32_t value : grid.row(y))
+                {
+                    sum += value;
+                }
+            }
+            doNotOptimize(sum); });
+
+    // Per cell transform, as used for GID remapping
+    for (auto [name, executor] : { std::pair { "serial", tpp::getSerialExecutor() }, std::pair { "threads", tpp::getThreadExecutor() } })
+    {
+        run(std::string("Transform (") + name + " executor)", 10, [&, &executor = executor]()
+            {
+                auto remapped = tpp::transform(grid, [](uint32_t, uint32_t, uint32_t gid)
+                    { return gid * 3 + 1; }, executor);
+                doNotOptimize(remapped); });
+    }
+
+    // Stamping a 64x64 prefab all over the grid
+    tpp::Array2D<uint32_t> prefab(64, 64, 7);
+
+    run("Stamp 64x64 prefabs, per cell at()", 10, [&]()
+        {
+            for (uint32_t start_y = 0; start_y < GRID_SIZE; start_y += 64)
+            {
+                for (uint32_t start_x = 0; start_x < GRID_SIZE; start_x += 64)
+                {
+                    for (uint32_t y = 0; y < 64; ++y)
+                    {
+                        for (uint32_t x = 0; x < 64; ++x)
+                        {
+                            grid.at(start_x + x, start_y + y) = prefab.at(x, y);
+                        }
+                    }
+                }
+            }
+            doNotOptimize(grid); });
+
+    run("Stamp 64x64 prefabs, blit", 10, [&]()
+        {
+            for (uint32_t start_y = 0; start_y < GRID_SIZE; start_y += 64)
+            {
+                for (uint32_t start_x = 0; start_x < GRID_SIZE; start_x += 64)
+                {
+                    tpp::blit(prefab.view(), grid.view(), { static_cast<int32_t>(start_x), static_cast<int32_t>(start_y) });
+                }
+            }
+            doNotOptimize(grid); });
+
+    // Mask queries: walkable AND visible, then count
+    tpp::Array2D<uint8_t> walkable_bytes(GRID_SIZE, GRID_SIZE);
+    tpp::Array2D<uint8_t> visible_bytes(GRID_SIZE, GRID_SIZE);
+    tpp::Array2D<bool> walkable_bits(GRID_SIZE, GRID_SIZE);
+    tpp::Array2D<bool> visible_bits(GRID_SIZE, GRID_SIZE);
+
+    for (uint32_t y = 0; y < GRID_SIZE; ++y)
+    {
+        for (uint32_t x = 0; x < GRID_SIZE; ++x)
+        {
+            bool walkable = (x * 7 + y * 13) % 5 != 0;
+            bool visible = (x / 32 + y / 32) % 2 == 0;
+
+            walkable_bytes(x, y) = walkable;
+            visible_bytes(x, y) = visible;
+            walkable_bits(x, y) = walkable;
+            visible_bits(x, y) = visible;
+        }
+    }
+
+    run("Mask AND + count (uint8_t per cell)", 10, [&]()
+        {
+            size_t count = 0;
+            const uint8_t* a = walkable_bytes.data();
+            const uint8_t* b = visible_bytes.data();
+            for (size_t i = 0; i < walkable_bytes.getStorageSize(); ++i)
+            {
+                count += a[i] & b[i];
+            }
+            doNotOptimize(count); });
+
+    run("Mask AND + count (bitset)", 10, [&]()
+        {
+            auto both = walkable_bits & visible_bits;
+            doNotOptimize(both.count()); });
+
+    runRegionScans<tpp::ChunkedLayout<16>>("chunked 16x16");
+    runRegionScans<tpp::ZOrderLayout>("z order");
+
+    // Past 2^32 cells: a 65536 x 65537 mask (512 MB)
+    std::printf("\n[Array2D past 2^32 cells]\n");
+    if (!bench::largeBenchmarksEnabled())
+    {
+        std::printf("Skipped, set TILEDCPP_BENCH_LARGE=1 to run\n");
+    }
+    else
+    {
+        tpp::Array2D<bool> huge(65536, 65537);
+
+        run("Mask 65536x65537, set every 97th cell", 1, [&]()
+            {
+                for (uint32_t y = 0; y < huge.size().y; ++y)
+                {
+                    for (uint32_t x = (y * 31) % 97; x < huge.size().x; x += 97)
+                    {
+                        huge(x, y) = true;
+                    }
+                } });
+
+        run("Mask 65536x65537, count", 3, [&]()
+            { doNotOptimize(huge.count()); });
+
+        run("Mask 65536x65537, findNextSet over every row", 3, [&]()
+            {
+                size_t found = 0;
+                for (uint32_t y = 0; y < huge.size().y; ++y)
+                {
+                    for (auto x = huge.findNextSet(0, y); x; x = huge.findNextSet(*x + 1, y))
+                    {
+                        ++found;
+                    }
+                }
+                doNotOptimize(found); });
+
+        run("Mask 65536x65537, read last row through at()", 3, [&]()
+            {
+                size_t found = 0;
+                for (uint32_t x = 0; x < huge.size().x; ++x)
+                {
+                    found += huge.at(x, huge.size().y - 1);
+                }
+                doNotOptimize(found); });
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace bench
+{
+
+// Runs fn the given number of times and prints the average time per iteration
+template <typename F>
+void run(const std::string& name, uint32_t iterations, F&& fn)
+{
+    // Warm up caches and the allocator
+    fn();
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double total_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::printf("%-48s %12.4f ms\n", name.c_str(), total_ms / iterations);
+}
+
+// Prevents the compiler from optimizing away a result
+template <typename T>
+void doNotOptimize(const T& value)
+{
+    // Publishing the address and reading back through it forces the value to be fully computed
+    static const void* volatile sink {};
+    sink = &value;
+    (void)*static_cast<const volatile char*>(sink);
+}
+
+// True if the TILEDCPP_BENCH_LARGE environment variable is set to a non empty value other than 0.
+// Benchmarks allocating hundreds of MB only run then
+bool largeBenchmarksEnabled();
+
+// Writes generated test content to a temporary directory, returns the full path
+std::string writeTempFile(const std::string& name, const std::string& contents);
+
+// Generates a tileset with tile_count tiles, every tile has a few properties and every 8th an animation
+std::string generateTileSet(const std::string& name, uint32_t tile_count);
+
+// Generates a CSV encoded map using the given tileset, with roughly density percent of non empty tiles
+std::string generateMap(const std::string& name, const std::string& tileset, uint32_t tile_count, uint32_t size, uint32_t layers, uint32_t density);
+
+void runLoadBenchmarks();
+void runLayerStorageBenchmarks();
+void runArray2DBenchmarks();
+void runAllocationBenchmarks();
+
+}
@@ -0,0 +1,51 @@
+#include "benchmark.hpp"
+
+#include <tiledcpp/tiledcpp.hpp>
+
+#include <vector>
+
+void bench::runLayerStorageBenchmarks()
+{
+    std::printf("\n[Layer Storage]\n");
+
+    auto map_path = generateMap("bench_storage_map", "bench_tileset.tsx", 200, 512, 4, 50);
+
+    for (auto [storage, name] : { std::pair { tpp::LayerStorage::Dense, "dense" },
+             std::pair { tpp::LayerStorage::RunLength, "run length" },
+             std::pair { tpp::LayerStorage::Sparse, "sparse" },
+             std::pair { tpp::LayerStorage::Paletted, "paletted" },
+             std::pair { tpp::LayerStorage::Compact16, "compact 16 bit" } })
+    {
+        tpp::LoadOptions options {};
+        options.load_images = false;
+        options.validation = tpp::ValidationMode::Trusted;
+        options.layer_storage = storage;
+
+        auto map = tpp::TileMap::fromTMX(map_path, options).value();
+        const auto& layers = map.getTileLayers();
+
+        std::vector<tpp::TileID> row(512);
+
+        run(std::string("Copy rows 512x512, 4 layers (") + name + ")", 20, [&]()
+            {
+                for (const auto& layer : layers)
+                {
+                    for (uint32_t y = 0; y < layer.size().y; ++y)
+                    {
+                        layer.copyRow(y, row.data());
+                        doNotOptimize(row);
+                    }
+                } });
+
+        run(std::string("Random at() 512x512, 1M reads (") + name + ")", 10, [&]()
+            {
+                uint32_t state = 1;
+                uint32_t sum = 0;
+                for (uint32_t i = 0; i < 1000000; ++i)
+                {
+                    state = state * 1664525u + 1013904223u;
+                    sum += layers[i & 3].at((state >> 8) & 511, (state >> 20) & 511).getRaw();
+                }
+                doNotOptimize(sum); });
+    }
+}
@@ -0,0 +1,202 @@
+#include "benchmark.hpp"
+
+#include <tiledcpp/property_binding.hpp>
+#include <tiledcpp/tiledcpp.hpp>
+
+namespace
+{
+
+struct BenchTile
+{
+    bool walkable = false;
+    int damage = 0;
+    float speed = 0.0f;
+};
+
+}
+
+template <>
+struct tpp::PropertyBinding<BenchTile>
+{
+    static constexpr auto fields = std::make_tuple(
+        tpp::bindField("walkable", &BenchTile::walkable),
+        tpp::bindField("damage", &BenchTile::damage),
+        tpp::bindField("speed", &BenchTile::speed));
+};
+
+void bench::runLoadBenchmarks()
+{
+    std::printf("\n[Loading]\n");
+
+    auto tileset_path = generateTileSet("bench_tileset", 10000);
+    auto map_path = generateMap("bench_map", "bench_tileset.tsx", 10000, 256, 16, 50);
+
+    tpp::LoadOptions validated {};
+    validated.load_images = false;
+
+    tpp::LoadOptions trusted = validated;
+    trusted.validation = tpp::ValidationMode::Trusted;
+
+    run("TileSet 10k tiles (validated)", 20, [&]()
+        { doNotOptimize(tpp::TileSet::fromTSX(tileset_path, validated)); });
+
+    run("TileSet 10k tiles (trusted)", 20, [&]()
+        { doNotOptimize(tpp::TileSet::fromTSX(tileset_path, trusted)); });
+
+    run("TileMap 256x256, 16 layers (validated)", 10, [&]()
+        { doNotOptimize(tpp::TileMap::fromTMX(map_path, validated)); });
+
+    run("TileMap 256x256, 16 layers (trusted)", 10, [&]()
+        { doNotOptimize(tpp::TileMap::fromTMX(map_path, trusted)); });
+
+    tpp::LoadOptions corner = trusted;
+    corner.region = tpp::URect { { 192, 192 }, { 32, 32 } };
+
+    run("TileMap 256x256, 16 layers, 32x32 region (trusted)", 10, [&]()
+        { doNotOptimize(tpp::TileMap::fromTMX(map_path, corner)); });
+
+    // Per tile metadata lookups, as done when spawning or animating tiles
+    auto tileset = tpp::TileSet::fromTSX(tileset_path, trusted).value();
+
+    run("TileSet 10k tiles, all property lookups", 200, [&]()
+        {
+            size_t found = 0;
+            for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+            {
+                found += tileset.getTileProperties(tile) != nullptr;
+            }
+            doNotOptimize(found); });
+
+    run("TileSet 10k tiles, all animation lookups", 200, [&]()
+        {
+            size_t frames = 0;
+            for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+            {
+                if (auto* animation = tileset.getTileAnimation(tile))
+                    frames += animation->frames.size();
+            }
+            doNotOptimize(frames); });
+
+    run("TileSet 10k tiles, get<float>(\"speed\")", 200, [&]()
+        {
+            float total = 0;
+            for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+            {
+                total += tileset.getTileProperties(tile)->get<float>("speed").value_or(0.0f);
+            }
+            doNotOptimize(total); });
+
+    const tpp::Name speed { "speed" };
+
+    run("TileSet 10k tiles, get<float>(Name)", 200, [&]()
+        {
+            float total = 0;
+            for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+            {
+                total += tileset.getTileProperties(tile)->get<float>(speed).value_or(0.0f);
+            }
+            doNotOptimize(total); });
+
+    run("TileSet 10k tiles, get<float>(TPP_KEY)", 200, [&]()
+        {
+            float total = 0;
+            for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+            {
+                total += tileset.getTileProperties(tile)->get<float>(TPP_KEY("speed")).value_or(0.0f);
+            }
+            doNotOptimize(total); });
+
+    run("TileSet 10k tiles, bindTileProperties", 20, [&]()
+        { doNotOptimize(tpp::bindTileProperties<BenchTile>(tileset)); });
+
+    auto bound = tpp::bindTileProperties<BenchTile>(tileset);
+
+    run("TileSet 10k tiles, bound speed field", 200, [&]()
+        {
+            float total = 0;
+            for (const BenchTile& tile : bound)
+            {
+                total += tile.speed;
+            }
+            doNotOptimize(total); });
+
+    run("TileSet 10k tiles, getTileRect() of every tile", 200, [&]()
+        {
+            uint64_t total = 0;
+            for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+            {
+                total += tileset.getTileRect(tile)->start.x;
+            }
+            doNotOptimize(total); });
+
+    std::vector<uint32_t> tile_ids(tileset.getTileCount());
+    std::vector<tpp::UVRect> tile_uvs(tile_ids.size());
+    for (uint32_t tile = 0; tile < tileset.getTileCount(); ++tile)
+    {
+        tile_ids[tile] = tile;
+    }
+
+    run("TileSet 10k tiles, batch getTileUVs()", 200, [&]()
+        {
+            tileset.getTileUVs(tpp::Span<const uint32_t>(tile_ids.data(), tile_ids.size()), tile_uvs.data());
+            doNotOptimize(tile_uvs.data()); });
+
+    // Per cell lookups of a draw pass: tileset, source rect and properties of every tile of a layer
+    auto map = tpp::TileMap::fromTMX(map_path, trusted).value();
+    const tpp::TileLayer& layer = map.getTileLayers().front();
+
+    run("Layer 256x256, per cell tileset/rect/properties", 50, [&]()
+        {
+            uint64_t total = 0;
+            for (tpp::TileID tile : *layer.getDense())
+            {
+                if (!tile.isValid())
+                    continue;
+
+                const tpp::TileSet& set = map.getTileSets()[map.getTileSetIndex(tile)];
+                uint32_t index = map.getTileIndex(tile);
+                total += set.getTileRect(index)->start.x + (set.getTileProperties(index) != nullptr);
+            }
+            doNotOptimize(total); });
+
+    run("Layer 256x256, per cell resolve()", 50, [&]()
+        {
+            uint64_t total = 0;
+            for (tpp::TileID tile : *layer.getDense())
+            {
+                const tpp::ResolvedTile& resolved = map.resolve(tile);
+                total += resolved.rect.start.x + (resolved.properties != nullptr);
+            }
+            doNotOptimize(total); });
+
+    // Vertex UVs of every cell, with the flip flags applied
+    tpp::LoadOptions oriented = trusted;
+    oriented.orientation_uvs = true;
+
+    auto oriented_map = tpp::TileMap::fromTMX(map_path, oriented).value();
+    const tpp::TileLayer& oriented_layer = oriented_map.getTileLayers().front();
+
+    run("Layer 256x256, per cell orientUVs()", 50, [&]()
+        {
+            float total = 0;
+            for (tpp::TileID tile : *oriented_layer.getDense())
+            {
+                tpp::UVQuad quad = tpp::orientUVs(oriented_map.resolve(tile).uvs, tile.getOrientation());
+                total += quad.corners[0].u + quad.corners[2].v;
+            }
+            doNotOptimize(total); });
+
+    run("Layer 256x256, per cell precomputed UV quad", 50, [&]()
+        {
+            float total = 0;
+            for (tpp::TileID tile : *oriented_layer.getDense())
+            {
+                const tpp::ResolvedTile& resolved = oriented_map.resolve(tile);
+                if (!resolved.isValid())
+                    continue;
+
+                const tpp::UVQuad& quad = resolved.uv_quads[tile.getOrientation()];
+                total += quad.corners[0].u + quad.corners[2].v;
+            }
+            doNotOptimize(total); });
+}
@@ -0,0 +1,110 @@
+#include "benchmark.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+bool bench::largeBenchmarksEnabled()
+{
+    const char* value = std::getenv("TILEDCPP_BENCH_LARGE");
+    return value != nullptr && value[0] != '\0' && std::string(value) != "0";
+}
+
+std::string bench::writeTempFile(const std::string& name, const std::string& contents)
+{
+    auto directory = std::filesystem::temp_directory_path() / "tiledcpp_benchmarks";
+    std::filesystem::create_directories(directory);
+
+    auto path = (directory / name).string();
+    std::ofstream file { path, std::ios::binary };
+    file << contents;
+
+    return path;
+}
+
+std::string bench::generateTileSet(const std::string& name, uint32_t tile_count)
+{
+    uint32_t columns = 64;
+
+    std::string out = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out += "<tileset version=\"1.10\" name=\"" + name + "\" tilewidth=\"16\" tileheight=\"16\" tilecount=\""
+        + std::to_string(tile_count) + "\" columns=\"" + std::to_string(columns) + "\">\n";
+    out += " <image source=\"missing.png\" width=\"" + std::to_string(columns * 16) + "\" height=\""
+        + std::to_string((tile_count + columns - 1) / columns * 16) + "\"/>\n";
+
+    for (uint32_t i = 0; i < tile_count; ++i)
+    {
+        out += " <tile id=\"" + std::to_string(i) + "\">\n";
+        out += "  <properties>\n";
+        out += "   <property name=\"walkable\" type=\"bool\" value=\"true\"/>\n";
+        out += "   <property name=\"damage\" type=\"int\" value=\"" + std::to_string(i % 10) + "\"/>\n";
+        out += "   <property name=\"speed\" type=\"float\" value=\"1.5\"/>\n";
+        out += "   <property name=\"kind\" value=\"tile_" + std::to_string(i) + "\"/>\n";
+        out += "   <property name=\"description\" value=\"Tile number " + std::to_string(i) + " of the generated tileset\"/>\n";
+        out += "  </properties>\n";
+
+        if (i % 8 == 0)
+        {
+            out += "  <animation>\n";
+            out += "   <frame tileid=\"" + std::to_string(i) + "\" duration=\"100\"/>\n";
+            out += "   <frame tileid=\"" + std::to_string((i + 1) % tile_count) + "\" duration=\"100\"/>\n";
+            out += "  </animation>\n";
+        }
+
+        out += " </tile>\n";
+    }
+
+    out += "</tileset>\n";
+    return writeTempFile(name + ".tsx", out);
+}
+
+std::string bench::generateMap(const std::string& name, const std::string& tileset, uint32_t tile_count, uint32_t size, uint32_t layers, uint32_t density)
+{
+    std::string out = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out += "<map version=\"1.10\" orientation=\"orthogonal\" width=\"" + std::to_string(size) + "\" height=\""
+        + std::to_string(size) + "\" tilewidth=\"16\" tileheight=\"16\" infinite=\"0\">\n";
+    out += " <properties>\n  <property name=\"level\" type=\"int\" value=\"1\"/>\n </properties>\n";
+    out += " <tileset firstgid=\"1\" source=\"" + tileset + "\"/>\n";
+
+    // Simple LCG so the generated content is the same on every run
+    uint32_t state = 12345;
+    auto next = [&state]()
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    };
+
+    for (uint32_t l = 0; l < layers; ++l)
+    {
+        out += " <layer id=\"" + std::to_string(l + 1) + "\" name=\"Layer " + std::to_string(l) + "\" width=\""
+            + std::to_string(size) + "\" height=\"" + std::to_string(size) + "\">\n";
+        out += "  <data encoding=\"csv\">\n";
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                uint32_t gid = next() % 100 < density ? next() % tile_count + 1 : 0;
+                out += std::to_string(gid);
+
+                if (x + 1 < size || y + 1 < size)
+                    out += ',';
+            }
+            out += '\n';
+        }
+
+        out += "</data>\n </layer>\n";
+    }
+
+    out += "</map>\n";
+    return writeTempFile(name + ".tmx", out);
+}
+
+int main()
+{
+    bench::runLoadBenchmarks();
+    bench::runLayerStorageBenchmarks();
+    bench::runArray2DBenchmarks();
+    bench::runAllocationBenchmarks();
+    return 0;
+}
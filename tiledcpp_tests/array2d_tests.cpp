@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include <tiledcpp/types/array2d.hpp>
+#include <tiledcpp/types/sparse_grid.hpp>
+
+#include <algorithm>
+#include <numeric>
 
 TEST(Array2DTest, ConstructWithDefaultValue)
 {
@@ -91,4 +95,393 @@ TEST(Array2DTest, RangeBasedForLoop)
     {
         EXPECT_EQ(elem, 3);
     }
-}
\ No newline at end of file
+}
+
+template <typename Layout>
+class Array2DLayoutTest : public ::testing::Test
+{
+};
+
+using Array2DLayouts = ::testing::Types<tpp::RowMajorLayout, tpp::ChunkedLayout<16>, tpp::ChunkedLayout<4>, tpp::ZOrderLayout>;
+TYPED_TEST_SUITE(Array2DLayoutTest, Array2DLayouts);
+
+TYPED_TEST(Array2DLayoutTest, IndicesAreUnique)
+{
+    // Sizes that are not multiples of the chunk size or powers of two
+    for (tpp::UVec2 size : { tpp::UVec2 { 37, 19 }, tpp::UVec2 { 5, 70 }, tpp::UVec2 { 1, 1 } })
+    {
+        TypeParam layout { size };
+        std::vector<bool> used(layout.getStorageSize(), false);
+
+        for (uint32_t y = 0; y < size.y; ++y)
+        {
+            for (uint32_t x = 0; x < size.x; ++x)
+            {
+                size_t index = layout.getIndex(x, y);
+                ASSERT_LT(index, used.size());
+                EXPECT_FALSE(used[index]);
+                used[index] = true;
+            }
+        }
+    }
+}
+
+TYPED_TEST(Array2DLayoutTest, AccessAndIterateInRowOrder)
+{
+    tpp::Array2D<int, TypeParam> array(37, 19);
+
+    for (uint32_t y = 0; y < 19; ++y)
+    {
+        for (uint32_t x = 0; x < 37; ++x)
+        {
+            array.at(x, y) = static_cast<int>(y * 37 + x);
+        }
+    }
+
+    int expected = 0;
+    for (auto it = array.begin(); it != array.end(); ++it, ++expected)
+    {
+        EXPECT_EQ(*it, expected);
+
+        auto [x, y] = it.getIndices();
+        EXPECT_EQ(array.at(x, y), expected);
+    }
+    EXPECT_EQ(expected, 37 * 19);
+
+    std::vector<int> row(37);
+    array.copyRow(11, row.data());
+    for (uint32_t x = 0; x < 37; ++x)
+    {
+        EXPECT_EQ(row[x], static_cast<int>(11 * 37 + x));
+    }
+
+    int visited = 0;
+    array.forEachNonEmpty([&](uint32_t x, uint32_t y, int value)
+        {
+            EXPECT_EQ(value, static_cast<int>(y * 37 + x));
+            ++visited; });
+
+    // Only the first element is empty
+    EXPECT_EQ(visited, 37 * 19 - 1);
+    EXPECT_THROW(array.at(37, 0), std::out_of_range);
+}
+
+TEST(Array2DTest, RandomAccessIterator)
+{
+    tpp::Array2D<int> array(4, 3);
+    std::iota(array.begin(), array.end(), 0);
+
+    auto begin = array.begin();
+    EXPECT_EQ(array.end() - begin, 12);
+    EXPECT_EQ(begin[5], 5);
+    EXPECT_EQ(*(begin + 7), 7);
+    EXPECT_EQ((begin + 7).getIndices(), (tpp::UVec2 { 3, 1 }));
+    EXPECT_TRUE(begin < begin + 1);
+
+    // Contiguous with the row major layout
+    EXPECT_EQ(&*(begin + 9), array.data() + 9);
+
+    // Postfix increment returns the previous position
+    auto it = begin;
+    EXPECT_EQ(*it++, 0);
+    EXPECT_EQ(*it, 1);
+
+    std::sort(array.begin(), array.end(), std::greater<int>());
+    EXPECT_EQ(array.at(0, 0), 11);
+    EXPECT_EQ(array.at(3, 2), 0);
+
+    // Also usable with other layouts, in row order
+    tpp::Array2D<int, tpp::ZOrderLayout> z_array(5, 3);
+    std::iota(z_array.begin(), z_array.end(), 0);
+    std::reverse(z_array.begin(), z_array.end());
+    EXPECT_EQ(z_array.at(0, 0), 14);
+    EXPECT_EQ(z_array.at(4, 2), 0);
+}
+
+TEST(Array2DTest, RowSpansAndUncheckedAccess)
+{
+    tpp::Array2D<int> array(3, 2);
+    std::iota(array.begin(), array.end(), 1);
+
+    auto row = array.row(1);
+    ASSERT_EQ(row.size(), 3);
+    EXPECT_EQ(row[0], 4);
+    EXPECT_EQ(std::accumulate(row.begin(), row.end(), 0), 4 + 5 + 6);
+
+    row[2] = 42;
+    EXPECT_EQ(array(2, 1), 42);
+    EXPECT_EQ(array.data()[5], 42);
+
+    const auto& const_ref = array;
+    EXPECT_EQ(const_ref.row(0).at(1), 2);
+    EXPECT_THROW(const_ref.row(2), std::out_of_range);
+}
+
+TEST(Array2DBitsetTest, SetAndCount)
+{
+    // Width that is not a multiple of the word size
+    tpp::Array2D<bool> mask(130, 3);
+    EXPECT_EQ(mask.getWordsPerRow(), 3);
+    EXPECT_FALSE(mask.any());
+
+    mask.at(0, 0) = true;
+    mask.at(64, 1) = true;
+    mask.at(129, 2) = true;
+    mask(5, 2) = true;
+
+    EXPECT_TRUE(mask.at(64, 1));
+    EXPECT_FALSE(mask.at(63, 1));
+    EXPECT_EQ(mask.count(), 4);
+    EXPECT_EQ(mask.countRow(2), 2);
+    EXPECT_THROW(mask.at(130, 0), std::out_of_range);
+
+    mask.at(0, 0) = false;
+    EXPECT_EQ(mask.count(), 3);
+
+    std::vector<std::pair<uint32_t, uint32_t>> visited;
+    mask.forEachNonEmpty([&](uint32_t x, uint32_t y, bool)
+        { visited.emplace_back(x, y); });
+
+    std::vector<std::pair<uint32_t, uint32_t>> expected { { 64, 1 }, { 5, 2 }, { 129, 2 } };
+    EXPECT_EQ(visited, expected);
+}
+
+TEST(Array2DBitsetTest, BooleanOperations)
+{
+    tpp::Array2D<bool> a(70, 2);
+    tpp::Array2D<bool> b(70, 2);
+
+    a.at(1, 0) = true;
+    a.at(69, 1) = true;
+    b.at(69, 1) = true;
+    b.at(2, 1) = true;
+
+    EXPECT_EQ((a & b).count(), 1);
+    EXPECT_EQ((a | b).count(), 3);
+    EXPECT_EQ((a ^ b).count(), 2);
+    EXPECT_EQ(tpp::Array2D<bool>(a).subtract(b).count(), 1);
+
+    // Inverting keeps the bits past the width clear
+    EXPECT_EQ((~a).count(), 70 * 2 - 2);
+    EXPECT_EQ(~~a, a);
+    EXPECT_EQ(tpp::Array2D<bool>(70, 2, true).count(), 140);
+
+    EXPECT_THROW(a &= tpp::Array2D<bool>(71, 2), std::invalid_argument);
+}
+
+TEST(Array2DBitsetTest, FindNextSet)
+{
+    tpp::Array2D<bool> mask(200, 1);
+    mask.at(3, 0) = true;
+    mask.at(150, 0) = true;
+
+    EXPECT_EQ(mask.findNextSet(0, 0), 3u);
+    EXPECT_EQ(mask.findNextSet(3, 0), 3u);
+    EXPECT_EQ(mask.findNextSet(4, 0), 150u);
+    EXPECT_EQ(mask.findNextSet(151, 0), std::nullopt);
+    EXPECT_EQ(mask.findNextSet(500, 0), std::nullopt);
+}
+
+TEST(Array2DBitsetTest, IteratorsAndFill)
+{
+    tpp::Array2D<bool> mask(130, 4);
+
+    mask.fill({ { 60, 1 }, { 70, 2 } }, true);
+    EXPECT_EQ(mask.count(), 140);
+    EXPECT_FALSE(mask.at(59, 1));
+    EXPECT_TRUE(mask.at(60, 1));
+    EXPECT_TRUE(mask.at(129, 2));
+    EXPECT_FALSE(mask.at(60, 3));
+
+    // Within a single word
+    mask.fill({ { 62, 1 }, { 1, 1 } }, false);
+    EXPECT_EQ(mask.count(), 139);
+    EXPECT_THROW(mask.fill({ { 100, 0 }, { 31, 1 } }, true), std::out_of_range);
+
+    size_t set = 0;
+    for (auto it = mask.begin(); it != mask.end(); ++it)
+    {
+        if (*it)
+        {
+            tpp::UVec2 xy = it.getIndices();
+            EXPECT_TRUE(mask.at(xy));
+            ++set;
+        }
+    }
+    EXPECT_EQ(set, mask.count());
+    EXPECT_EQ(mask.end() - mask.begin(), 130 * 4);
+
+    // Writing through the proxy
+    for (auto cell : mask)
+    {
+        cell = !cell;
+    }
+    EXPECT_EQ(mask.count(), 130 * 4 - 139);
+
+    const auto& const_mask = mask;
+    EXPECT_EQ(std::count(const_mask.begin(), const_mask.end(), true), 130 * 4 - 139);
+    EXPECT_TRUE(const_mask.begin()[131]);
+
+    mask.fill(true);
+    EXPECT_EQ(mask.count(), 130 * 4);
+    mask.fill(false);
+    EXPECT_FALSE(mask.any());
+}
+
+TEST(Array2DViewTest, SubViewsAndFill)
+{
+    tpp::Array2D<int> array(5, 4, 0);
+
+    array.fill({ { 1, 1 }, { 3, 2 } }, 7);
+
+    auto view = array.view({ { 1, 1 }, { 3, 2 } });
+    EXPECT_EQ(view.size(), (tpp::UVec2 { 3, 2 }));
+    EXPECT_EQ(view.getStride(), 5);
+    EXPECT_EQ(view.at(2, 1), 7);
+    EXPECT_EQ(&view(0, 1), &array.at(1, 2));
+
+    int sum = 0;
+    for (int value : array)
+    {
+        sum += value;
+    }
+    EXPECT_EQ(sum, 7 * 6);
+
+    EXPECT_THROW(array.view({ { 3, 0 }, { 3, 1 } }), std::out_of_range);
+    EXPECT_THROW(view.at(3, 0), std::out_of_range);
+
+    tpp::Array2DView<const int> read_only = view;
+    EXPECT_EQ(read_only.row(0)[0], 7);
+}
+
+TEST(Array2DViewTest, CopyRegionAndBlit)
+{
+    tpp::Array2D<int> prefab(3, 2);
+    std::iota(prefab.begin(), prefab.end(), 1);
+
+    tpp::Array2D<int> map(6, 4, 0);
+
+    tpp::copyRegion(prefab.view(), map.view({ { 2, 1 }, { 3, 2 } }));
+    EXPECT_EQ(map.at(2, 1), 1);
+    EXPECT_EQ(map.at(4, 2), 6);
+    EXPECT_THROW(tpp::copyRegion(prefab.view(), map.view({ { 0, 0 }, { 2, 2 } })), std::invalid_argument);
+
+    // Partially outside on the top left and bottom right
+    map.fill(0);
+    tpp::blit(prefab.view(), map.view(), { -1, -1 });
+    EXPECT_EQ(map.at(0, 0), 5);
+    EXPECT_EQ(map.at(1, 0), 6);
+    EXPECT_EQ(map.at(2, 0), 0);
+
+    tpp::blit(prefab.view(), map.view(), { 5, 3 });
+    EXPECT_EQ(map.at(5, 3), 1);
+
+    // Fully outside does nothing
+    tpp::blit(prefab.view(), map.view(), { 6, 0 });
+    tpp::blit(prefab.view(), map.view(), { -3, 0 });
+
+    int count = 0;
+    map.forEachNonEmpty([&count](uint32_t, uint32_t, int)
+        { ++count; });
+    EXPECT_EQ(count, 3);
+}
+
+TEST(Array2DViewTest, OverlappingCopy)
+{
+    tpp::Array2D<int> array(4, 4);
+    std::iota(array.begin(), array.end(), 0);
+
+    // Shift a 3x3 block one down and right, onto itself
+    tpp::copyRegion(array.view({ { 0, 0 }, { 3, 3 } }), array.view({ { 1, 1 }, { 3, 3 } }));
+    EXPECT_EQ(array.at(1, 1), 0);
+    EXPECT_EQ(array.at(3, 3), 10);
+    EXPECT_EQ(array.at(2, 3), 9);
+
+    // And back up left
+    tpp::copyRegion(array.view({ { 1, 1 }, { 3, 3 } }), array.view({ { 0, 0 }, { 3, 3 } }));
+    EXPECT_EQ(array.at(0, 0), 0);
+    EXPECT_EQ(array.at(2, 2), 10);
+}
+
+TEST(Array2DTest, IndicesPastFourGigaCells)
+{
+    // 70000 x 70000 cells is past 2^32, only the index math is checked so nothing gets allocated
+    const tpp::UVec2 size { 70000, 70000 };
+    const size_t cells = static_cast<size_t>(size.x) * size.y;
+    ASSERT_GT(cells, size_t(1) << 32);
+
+    tpp::RowMajorLayout row_major { size };
+    EXPECT_EQ(row_major.getStorageSize(), cells);
+    EXPECT_EQ(row_major.getIndex(size.x - 1, size.y - 1), cells - 1);
+
+    tpp::ChunkedLayout<16> chunked { size };
+    EXPECT_GE(chunked.getStorageSize(), cells);
+    EXPECT_LT(chunked.getIndex(size.x - 1, size.y - 1), chunked.getStorageSize());
+    EXPECT_GT(chunked.getIndex(size.x - 1, size.y - 1), size_t(1) << 32);
+
+    tpp::ZOrderLayout z_order { size };
+    EXPECT_EQ(z_order.getStorageSize(), size_t(1) << 34);
+    EXPECT_EQ(z_order.getIndex(65536, 0), size_t(1) << 32);
+    EXPECT_EQ(z_order.getIndex(0, 65536), size_t(1) << 33);
+    EXPECT_LT(z_order.getIndex(size.x - 1, size.y - 1), z_order.getStorageSize());
+
+    tpp::Array2DIterator<const int> it(nullptr, row_major, cells - 2, size.x);
+    EXPECT_EQ(it.getIndices(), (tpp::UVec2 { size.x - 2, size.y - 1 }));
+    EXPECT_EQ((it + 1) - it, 1);
+
+    // Chunk counts round up without wrapping next to 2^32
+    const tpp::UVec2 widest { 0xFFFFFFFF, 1 };
+    tpp::ChunkedLayout<16> wide_chunked { widest };
+    EXPECT_EQ(wide_chunked.getStorageSize(), size_t(0x10000000) * 16 * 16);
+    EXPECT_LT(wide_chunked.getIndex(widest.x - 1, 0), wide_chunked.getStorageSize());
+
+    // 2^64 cells once padded
+    EXPECT_THROW(tpp::ZOrderLayout(tpp::UVec2 { 0xFFFFFFFF, 0xFFFFFFFF }), std::length_error);
+}
+
+TEST(Array2DTest, SparseGridPastFourGigaCells)
+{
+    // 65536 x 65537 cells, built from its few non empty cells so only the chunk table (64 MB) gets allocated
+    const tpp::UVec2 size { 65536, 65537 };
+    ASSERT_GT(static_cast<size_t>(size.x) * size.y, size_t(1) << 32);
+
+    std::vector<std::pair<tpp::UVec2, uint32_t>> cells {
+        { { 0, 0 }, 1 },
+        { { 1, 65536 }, 2 },
+        { { 65535, 65536 }, 3 },
+        { { 65535, 65536 }, 4 },
+        { { 40000, 30000 }, 5 },
+        { { 40000, 30000 }, 0 },
+    };
+
+    auto grid = tpp::SparseGrid<uint32_t>::fromCells(size, cells.begin(), cells.end());
+    EXPECT_EQ(grid.size(), size);
+    EXPECT_EQ(grid.getChunkCount(), 4);
+
+    EXPECT_EQ(grid.at(0, 0), 1);
+    EXPECT_EQ(grid.at(65535, 65536), 4);
+    EXPECT_EQ(grid.at(40000, 30000), 0);
+    EXPECT_EQ(grid.at(65534, 65536), 0);
+
+    std::vector<uint32_t> row(size.x);
+    grid.copyRow(size.y - 1, row.data());
+    EXPECT_EQ(row[1], 2);
+    EXPECT_EQ(row[65535], 4);
+    EXPECT_EQ(std::count(row.begin(), row.end(), 0u), 65534);
+
+    std::vector<std::pair<tpp::UVec2, uint32_t>> visited;
+    grid.forEachNonEmpty([&visited](uint32_t x, uint32_t y, uint32_t value)
+        { visited.push_back({ { x, y }, value }); });
+
+    ASSERT_EQ(visited.size(), 3);
+    EXPECT_EQ(visited[2].first, (tpp::UVec2 { 65535, 65536 }));
+
+    // Widths within a chunk of 2^32 still get their last chunk. Large chunks keep the chunk table at 16 MB
+    std::vector<std::pair<tpp::UVec2, uint32_t>> edge { { { 0xFFFFFFFE, 0 }, 7 } };
+    auto wide = tpp::SparseGrid<uint32_t, 1024>::fromCells({ 0xFFFFFFFF, 1 }, edge.begin(), edge.end());
+    EXPECT_EQ(wide.at(0xFFFFFFFE, 0), 7);
+    EXPECT_EQ(wide.getChunkCount(), 1);
+
+    std::vector<std::pair<tpp::UVec2, uint32_t>> outside { { { 0, 65537 }, 1 } };
+    EXPECT_THROW(tpp::SparseGrid<uint32_t>::fromCells(size, outside.begin(), outside.end()), std::out_of_range);
+}
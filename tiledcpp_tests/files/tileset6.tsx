@@ -0,0 +1,18 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<tileset version="1.10" tiledversion="1.11.2" name="image3" tilewidth="4" tileheight="4" tilecount="4" columns="4">
+ <image source="image3.png" width="16" height="4"/>
+ <tile id="400000000">
+  <properties>
+   <property name="huge" type="int" value="1"/>
+  </properties>
+ </tile>
+ <tile id="1">
+  <properties>
+   <property name="speed" type="float" value="2.5"/>
+   <property name="position" type="vec3" value="1,2,3"/>
+   <property name="target" type="object" value="7"/>
+   <property name="notes">first line
+second line</property>
+  </properties>
+ </tile>
+</tileset>
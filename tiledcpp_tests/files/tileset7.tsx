@@ -0,0 +1,4 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<tileset version="1.10" tiledversion="1.11.2" name="image3" tilewidth="4" tileheight="4" tilecount="4" columns="0">
+ <image source="image3.png" width="16" height="4"/>
+</tileset>
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include <tiledcpp/tiledcpp.hpp>
+
+#include <fstream>
+
+namespace
+{
+
+// 40x20 grid, mostly empty with a horizontal strip and a few scattered values
+std::vector<uint32_t> makeValues()
+{
+    std::vector<uint32_t> values(40 * 20, 0);
+
+    for (uint32_t x = 5; x < 30; ++x)
+        values[3 * 40 + x] = 7;
+
+    values[0] = 1;
+    values[17 * 40 + 39] = 2;
+    values[19 * 40 + 20] = 3;
+
+    return values;
+}
+
+template <typename Grid>
+void checkGrid(const Grid& grid, const std::vector<uint32_t>& values)
+{
+    ASSERT_EQ(grid.size(), (tpp::UVec2 { 40, 20 }));
+
+    std::vector<uint32_t> row(40);
+    for (uint32_t y = 0; y < 20; ++y)
+    {
+        grid.copyRow(y, row.data());
+
+        for (uint32_t x = 0; x < 40; ++x)
+        {
+            EXPECT_EQ(grid.at(x, y), values[y * 40 + x]);
+            EXPECT_EQ(row[x], values[y * 40 + x]);
+        }
+    }
+
+    std::vector<uint32_t> visited(values.size(), 0);
+    grid.forEachNonEmpty([&](uint32_t x, uint32_t y, uint32_t value)
+        { visited[y * 40 + x] = value; });
+
+    EXPECT_EQ(visited, values);
+    EXPECT_THROW(grid.at(40, 0), std::out_of_range);
+}
+
+}
+
+TEST(LayerStorageTests, RunLengthGrid)
+{
+    auto values = makeValues();
+    auto grid = tpp::RunLengthGrid<uint32_t>::fromRowMajor({ 40, 20 }, values.begin());
+
+    checkGrid(grid, values);
+
+    // One run per row, plus the extra runs of the rows holding values
+    EXPECT_EQ(grid.getRunCount(), 20 + 1 + 2 + 1 + 2);
+}
+
+TEST(LayerStorageTests, SparseGrid)
+{
+    auto values = makeValues();
+    auto grid = tpp::SparseGrid<uint32_t>::fromRowMajor({ 40, 20 }, values.begin());
+
+    checkGrid(grid, values);
+    EXPECT_EQ(grid.getChunkCount(), 4);
+}
+
+TEST(LayerStorageTests, PalettedGrid)
+{
+    auto values = makeValues();
+    auto grid = tpp::PalettedGrid<uint32_t>::fromRowMajor({ 40, 20 }, values.begin());
+
+    checkGrid(grid, values);
+    EXPECT_EQ(grid.getPalette().size(), 5);
+    EXPECT_EQ(grid.getIndexBits(), 4);
+}
+
+TEST(LayerStorageTests, PalettedGridIndexSizes)
+{
+    // Odd width, so rows end in the middle of a block
+    const tpp::UVec2 size { 301, 200 };
+
+    for (uint32_t distinct : { 3u, 200u, 3000u, 40000u })
+    {
+        std::vector<uint32_t> values(size.x * size.y);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            values[i] = static_cast<uint32_t>((i * 7919) % distinct);
+        }
+
+        auto grid = tpp::PalettedGrid<uint32_t>::fromRowMajor(size, values.begin());
+        EXPECT_EQ(grid.getIndexBits(), tpp::PalettedGrid<uint32_t>::getIndexBits(distinct));
+
+        std::vector<uint32_t> row(size.x);
+        for (uint32_t y = 0; y < size.y; ++y)
+        {
+            grid.copyRow(y, row.data());
+            ASSERT_TRUE(std::equal(row.begin(), row.end(), values.begin() + y * size.x)) << distinct << " values, row " << y;
+            ASSERT_EQ(grid.at(size.x - 1, y), values[y * size.x + size.x - 1]);
+        }
+    }
+}
+
+TEST(LayerStorageTests, LoadWithEveryStorage)
+{
+    auto dense = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx");
+    ASSERT_TRUE(dense.has_value()) << dense.error().message;
+
+    for (auto storage : { tpp::LayerStorage::RunLength, tpp::LayerStorage::Sparse, tpp::LayerStorage::Paletted, tpp::LayerStorage::Compact16, tpp::LayerStorage::Automatic })
+    {
+        tpp::LoadOptions options {};
+        options.layer_storage = storage;
+
+        auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+        ASSERT_TRUE(result.has_value()) << result.error().message;
+
+        for (size_t i = 0; i < dense->getTileLayers().size(); ++i)
+        {
+            auto& expected = dense->getTileLayers().at(i);
+            auto& layer = result->getTileLayers().at(i);
+
+            if (storage != tpp::LayerStorage::Automatic)
+            {
+                EXPECT_EQ(layer.storage(), storage);
+            }
+
+            ASSERT_EQ(layer.size(), expected.size());
+            for (uint32_t y = 0; y < layer.size().y; ++y)
+            {
+                for (uint32_t x = 0; x < layer.size().x; ++x)
+                {
+                    EXPECT_EQ(layer.at(x, y), expected.at(x, y));
+                }
+            }
+        }
+    }
+}
+
+TEST(LayerStorageTests, AutomaticPicksSparseForEmptyLayers)
+{
+    tpp::LoadOptions options {};
+    options.layer_storage = tpp::LayerStorage::Automatic;
+
+    // Full 4x2 layer: 16 bit cells
+    auto full = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+    ASSERT_TRUE(full.has_value()) << full.error().message;
+    EXPECT_EQ(full->getTileLayers().at(0).storage(), tpp::LayerStorage::Compact16);
+
+    // Empty 2x2 layer: a single run per row beats everything
+    auto empty = tpp::TileMap::fromTMX("tiledcpp_tests/files/map3.tmx", options);
+    ASSERT_TRUE(empty.has_value()) << empty.error().message;
+    EXPECT_NE(empty->getTileLayers().at(0).storage(), tpp::LayerStorage::Dense);
+
+    size_t count = 0;
+    empty->getTileLayers().at(0).forEachNonEmpty([&count](uint32_t, uint32_t, tpp::TileID)
+        { ++count; });
+    EXPECT_EQ(count, 0);
+}
+
+TEST(LayerStorageTests, PalettedFallsBackToDense)
+{
+    // More distinct gids than a palette can index
+    constexpr uint32_t tile_count = 70000;
+    const std::string directory = testing::TempDir();
+    {
+        std::ofstream tileset { directory + "many_tiles.tsx", std::ios::binary };
+        tileset << "<tileset name=\"many\" tilewidth=\"4\" tileheight=\"4\" tilecount=\"" << tile_count << "\" columns=\"100\">"
+                << "<image source=\"many.png\" width=\"400\" height=\"2800\"/></tileset>\n";
+
+        std::ofstream map { directory + "many_tiles.tmx", std::ios::binary };
+        map << "<map width=\"300\" height=\"300\" tilewidth=\"4\" tileheight=\"4\">"
+            << "<tileset firstgid=\"1\" source=\"many_tiles.tsx\"/><layer width=\"300\" height=\"300\"><data encoding=\"csv\">\n";
+        for (uint32_t i = 0; i < 300 * 300; ++i)
+        {
+            map << (i % (tile_count + 1)) << (i + 1 < 300 * 300 ? "," : "\n");
+        }
+        map << "</data></layer></map>\n";
+    }
+
+    tpp::LoadOptions options {};
+    options.load_images = false;
+    options.layer_storage = tpp::LayerStorage::Paletted;
+
+    auto result = tpp::TileMap::fromTMX(directory + "many_tiles.tmx", options);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    const auto& layer = result->getTileLayers().at(0);
+    EXPECT_EQ(layer.storage(), tpp::LayerStorage::Dense);
+    EXPECT_EQ(layer.at(299, 299).getGid(), (300 * 300 - 1) % (tile_count + 1));
+
+    EXPECT_THROW(tpp::PalettedGrid<tpp::TileID>::fromRowMajor(layer.size(), layer.getDense()->begin()), std::length_error);
+}
+
+TEST(LayerStorageTests, CopyRegionAndMakeDense)
+{
+    for (auto storage : { tpp::LayerStorage::Dense, tpp::LayerStorage::RunLength, tpp::LayerStorage::Sparse, tpp::LayerStorage::Paletted, tpp::LayerStorage::Compact16 })
+    {
+        tpp::LoadOptions options {};
+        options.layer_storage = storage;
+
+        auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+        ASSERT_TRUE(result.has_value()) << result.error().message;
+
+        tpp::TileLayer layer = std::move(result->getTileLayers().at(0));
+
+        tpp::Array2D<tpp::TileID> region(2, 2);
+        layer.copyRegion({ { 1, 0 }, { 2, 2 } }, region.view());
+        EXPECT_EQ(region.at(0, 0), layer.at(1, 0));
+        EXPECT_EQ(region.at(1, 1), layer.at(2, 1));
+
+        tpp::Array2D<tpp::TileID>& dense = layer.makeDense();
+        EXPECT_EQ(layer.storage(), tpp::LayerStorage::Dense);
+        EXPECT_EQ(dense.at(2, 1), region.at(1, 1));
+
+        // Stamp the region back in the top left corner
+        tpp::blit(region.view(), dense.view(), { 0, 0 });
+        EXPECT_EQ(layer.at(0, 0), region.at(0, 0));
+    }
+}
+
+TEST(LayerStorageTests, Compact16SharesTableAcrossLayers)
+{
+    tpp::LoadOptions options {};
+    options.layer_storage = tpp::LayerStorage::Compact16;
+
+    auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    const auto& layers = result->getTileLayers();
+    ASSERT_GE(layers.size(), 2);
+
+    const auto& table = std::get<tpp::CompactTileGrid>(layers.front().tiles).table;
+
+    for (const auto& layer : layers)
+    {
+        ASSERT_EQ(layer.storage(), tpp::LayerStorage::Compact16);
+
+        const auto& grid = std::get<tpp::CompactTileGrid>(layer.tiles);
+        EXPECT_EQ(grid.table, table);
+        EXPECT_EQ(grid.ids.size(), layer.size());
+    }
+
+    // Index 0 is always the empty tile
+    EXPECT_FALSE(table->at(0).isValid());
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <tiledcpp/parallel.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+
+TEST(ParallelTests, ForRowsVisitsEveryElementOnce)
+{
+    // Tall enough to be split in several bands
+    tpp::Array2D<int> array(300, 200, 0);
+
+    tpp::parallelForRows(array, [](uint32_t x, uint32_t y, int& value)
+        { value += static_cast<int>(y * 300 + x) + 1; });
+
+    int expected = 1;
+    for (int value : array)
+    {
+        EXPECT_EQ(value, expected++);
+    }
+}
+
+TEST(ParallelTests, TransformAndReduce)
+{
+    tpp::Array2D<uint32_t, tpp::ChunkedLayout<16>> gids(257, 129);
+    std::iota(gids.begin(), gids.end(), 0);
+
+    auto remapped = tpp::transform(gids, [](uint32_t, uint32_t, uint32_t gid)
+        { return static_cast<uint64_t>(gid) * 2; });
+
+    static_assert(std::is_same_v<decltype(remapped), tpp::Array2D<uint64_t, tpp::ChunkedLayout<16>>>);
+    EXPECT_EQ(remapped.size(), gids.size());
+    EXPECT_EQ(remapped.at(256, 128), (257ull * 129 - 1) * 2);
+
+    uint64_t sum = tpp::reduce(
+        remapped, uint64_t { 0 },
+        [](uint64_t acc, uint32_t, uint32_t, uint64_t value)
+        { return acc + value; },
+        [](uint64_t a, uint64_t b)
+        { return a + b; });
+
+    uint64_t count = 257ull * 129;
+    EXPECT_EQ(sum, count * (count - 1));
+}
+
+TEST(ParallelTests, CustomExecutor)
+{
+    std::atomic<size_t> tasks { 0 };
+    tpp::Executor counting = [&tasks](size_t task_count, const std::function<void(size_t)>& task)
+    {
+        tasks += task_count;
+        tpp::getSerialExecutor()(task_count, task);
+    };
+
+    tpp::Array2D<int> array(1000, 100, 1);
+
+    int total = tpp::reduce(
+        array, 0, [](int acc, uint32_t, uint32_t, int value)
+        { return acc + value; },
+        std::plus<int>(), counting);
+
+    EXPECT_EQ(total, 1000 * 100);
+    EXPECT_GT(tasks.load(), 1);
+
+    // Empty arrays run nothing
+    tpp::Array2D<int> empty {};
+    tpp::parallelForRows(empty, [](uint32_t, uint32_t, int&)
+        { FAIL(); }, counting);
+}
+
+TEST(ParallelTests, TransformToMask)
+{
+    tpp::Array2D<uint32_t> gids(300, 100);
+    std::iota(gids.begin(), gids.end(), 0);
+
+    // Bands never share words, so writing bits from several threads is safe
+    auto even = tpp::transform(gids, [](uint32_t, uint32_t, uint32_t gid)
+        { return gid % 2 == 0; });
+
+    static_assert(std::is_same_v<decltype(even), tpp::Array2D<bool>>);
+    EXPECT_EQ(even.count(), 300 * 100 / 2);
+    EXPECT_TRUE(even.at(0, 1));
+    EXPECT_FALSE(even.at(1, 1));
+}
+
+TEST(ParallelTests, ExceptionsReachTheCaller)
+{
+    tpp::Array2D<int> array(1000, 100, 0);
+
+    for (uint32_t throw_row : { 0u, 99u })
+    {
+        EXPECT_THROW(tpp::parallelForRows(array, [throw_row](uint32_t, uint32_t y, int&)
+                         {
+                             if (y == throw_row)
+                                 throw std::runtime_error("task failed"); }),
+            std::runtime_error);
+    }
+
+    // The pool is still usable afterwards, including from inside a task
+    int total = tpp::reduce(
+        array, 0, [](int acc, uint32_t x, uint32_t y, int)
+        {
+            if (x == 0 && y == 0)
+            {
+                tpp::Array2D<int> inner(200, 200, 1);
+                tpp::parallelForRows(inner, [](uint32_t, uint32_t, int& value)
+                    { value = 2; });
+                return acc + inner.at(199, 199);
+            }
+            return acc + 1; },
+        std::plus<int>());
+
+    EXPECT_EQ(total, 1000 * 100 + 1);
+}
+
+TEST(ParallelTests, TileLayers)
+{
+    for (auto storage : { tpp::LayerStorage::Dense, tpp::LayerStorage::RunLength, tpp::LayerStorage::Paletted })
+    {
+        tpp::LoadOptions options {};
+        options.layer_storage = storage;
+
+        auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+        ASSERT_TRUE(result.has_value()) << result.error().message;
+
+        const tpp::TileLayer& layer = result->getTileLayers().at(0);
+
+        auto gids = tpp::transform(layer, [](uint32_t, uint32_t, tpp::TileID tile)
+            { return tile.getGid(); });
+
+        ASSERT_EQ(gids.size(), layer.size());
+        EXPECT_EQ(gids.at(3, 1), layer.at(3, 1).getGid());
+
+        uint64_t sum = tpp::reduce(
+            layer, uint64_t { 0 }, [](uint64_t acc, uint32_t, uint32_t, tpp::TileID tile)
+            { return acc + tile.getGid(); },
+            std::plus<uint64_t>());
+
+        std::atomic<uint64_t> visited_sum { 0 };
+        tpp::parallelForRows(layer, [&visited_sum](uint32_t, uint32_t, tpp::TileID tile)
+            { visited_sum += tile.getGid(); });
+
+        EXPECT_EQ(sum, std::accumulate(gids.begin(), gids.end(), uint64_t { 0 }));
+        EXPECT_EQ(visited_sum.load(), sum);
+    }
+}
@@ -79,4 +79,54 @@ TEST(ParseHelperTests, GetDirectory)
 {
     std::string path = "/base/path/image.png";
     EXPECT_EQ(tpp::detail::getDirectory(path), "/base/path");
-}
\ No newline at end of file
+}
+
+TEST(ParseHelperTests, ParseCSVRegion)
+{
+    // One row per line, like Tiled writes it
+    std::string_view str = "\n1,2,3,4,\r\n5,6,7,8,\r\n9,10,11,12\n";
+    auto result = tpp::detail::parseCSVRegion(str, { 4, 3 }, { { 1, 1 }, { 2, 2 } });
+
+    std::vector<uint32_t> expected = { 6, 7, 10, 11 };
+    EXPECT_EQ(result, expected);
+
+    // Regions touching the right edge
+    auto right = tpp::detail::parseCSVRegion(str, { 4, 3 }, { { 2, 0 }, { 2, 3 } });
+    std::vector<uint32_t> expected_right = { 3, 4, 7, 8, 11, 12 };
+    EXPECT_EQ(right, expected_right);
+}
+
+TEST(ParseHelperTests, ParseCSVRegionSingleLine)
+{
+    std::string_view str = "1,2,3,4,5,6,7,8,9,10,11,12";
+    auto result = tpp::detail::parseCSVRegion(str, { 4, 3 }, { { 1, 1 }, { 2, 2 } });
+
+    std::vector<uint32_t> expected = { 6, 7, 10, 11 };
+    EXPECT_EQ(result, expected);
+}
+
+TEST(ParseHelperTests, ParseCSVRegionClamped)
+{
+    std::string_view str = "1,2,\n3,4";
+
+    // The region is clamped to the grid instead of reading past the rows
+    auto result = tpp::detail::parseCSVRegion(str, { 2, 2 }, { { 1, 1 }, { 5, 5 } });
+    std::vector<uint32_t> expected = { 4 };
+    EXPECT_EQ(result, expected);
+
+    EXPECT_TRUE(tpp::detail::parseCSVRegion(str, { 2, 2 }, { { 3, 0 }, { 1, 1 } }).empty());
+}
+
+TEST(ParseHelperTests, ParseBase64Region)
+{
+    // Little endian uint32 values 1 to 8, for a 4x2 grid
+    std::string_view str = "\n   AQAAAAIAAAADAAAABAAAAAUAAAAGAAAABwAAAAgAAAA=\n  ";
+
+    auto full = tpp::detail::parseBase64Region(str, { 4, 2 }, { { 0, 0 }, { 4, 2 } });
+    std::vector<uint32_t> expected_full = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    EXPECT_EQ(full, expected_full);
+
+    auto region = tpp::detail::parseBase64Region(str, { 4, 2 }, { { 1, 0 }, { 2, 2 } });
+    std::vector<uint32_t> expected_region = { 2, 3, 6, 7 };
+    EXPECT_EQ(region, expected_region);
+}
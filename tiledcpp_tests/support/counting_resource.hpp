@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Shared by the unit tests and the benchmarks
+namespace test_support
+{
+
+// Forwards to upstream, counting the blocks taken from it
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream)
+        : upstream(upstream)
+    {
+    }
+
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations;
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override { upstream->deallocate(ptr, bytes, alignment); }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource* upstream;
+};
+
+}
@@ -1,6 +1,13 @@
 #include <gtest/gtest.h>
+#include <tiledcpp/detail/parse_helpers.hpp>
+#include <tiledcpp/property_binding.hpp>
 #include <tiledcpp/tiledcpp.hpp>
 
+#include "support/counting_resource.hpp"
+
+#include <fstream>
+#include <memory_resource>
+
 TEST(ImageTests, LoadImageFile)
 {
     auto result = tpp::Image::fromPath("tiledcpp_tests/files/image.png");
@@ -43,6 +50,36 @@ TEST(TileSetTests, CheckSpacingMarginMetrics)
     }
 }
 
+TEST(TileSetTests, RectAndUVTables)
+{
+    tpp::LoadOptions options {};
+    options.inset_uvs = true;
+
+    auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset2.tsx", options);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    ASSERT_EQ(result->getTileRects().size(), 16);
+    ASSERT_EQ(result->getTileUVs().size(), 16);
+
+    // Column 1, row 1 with a margin of 1 and spacing of 2
+    EXPECT_EQ(result->getTileRects()[5].start, (tpp::UVec2 { 5, 5 }));
+    EXPECT_EQ(result->getTileRects()[5].size, (tpp::UVec2 { 2, 2 }));
+
+    const tpp::UVRect& uvs = result->getTileUVs()[5];
+    EXPECT_FLOAT_EQ(uvs.u0, 5.5f / 18.0f);
+    EXPECT_FLOAT_EQ(uvs.v0, 5.5f / 18.0f);
+    EXPECT_FLOAT_EQ(uvs.u1, 6.5f / 18.0f);
+    EXPECT_FLOAT_EQ(uvs.v1, 6.5f / 18.0f);
+
+    const uint32_t ids[] = { 5, 100 };
+    tpp::URect rects[2] {};
+    result->getTileRects(tpp::Span<const uint32_t>(ids, 2), rects);
+
+    EXPECT_EQ(rects[0].start, (tpp::UVec2 { 5, 5 }));
+    EXPECT_EQ(rects[1].size, (tpp::UVec2 { 0, 0 }));
+    EXPECT_FALSE(result->getTileRect(100).has_value());
+}
+
 TEST(TileSetTests, Animations)
 {
     auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset3.tsx");
@@ -61,6 +98,28 @@ TEST(TileSetTests, Animations)
     EXPECT_EQ(frames[1].tile_id, 1);
 }
 
+TEST(TileSetTests, MetadataSurvivesMove)
+{
+    auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset3.tsx");
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    std::vector<tpp::TileSet> tilesets {};
+    tilesets.emplace_back(std::move(result.value()));
+    tilesets.resize(8);
+
+    auto& tileset = tilesets.front();
+    EXPECT_EQ(tileset.getTileAnimation(1), nullptr);
+    EXPECT_EQ(tileset.getTileProperties(0), nullptr);
+    EXPECT_EQ(tileset.getTileProperties(1000), nullptr);
+    EXPECT_EQ(tilesets.back().getTileAnimation(0), nullptr);
+
+    auto anim = tileset.getTileAnimation(0);
+    ASSERT_TRUE(anim != nullptr);
+    ASSERT_EQ(anim->frames.size(), 2);
+    EXPECT_EQ(anim->frames[1].duration_ms, 20);
+    EXPECT_EQ(tileset.getTileProperties(1)->get<int>("IntProp"), 42);
+}
+
 TEST(TileSetTests, CustomProperties)
 {
     auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset3.tsx");
@@ -88,6 +147,154 @@ TEST(TileSetTests, CustomProperties)
     checkProp(map, "StringProp", std::string("Hello World"));
 }
 
+TEST(PropertyMapTests, NameKeys)
+{
+    tpp::Name speed { "speed" };
+    EXPECT_EQ(speed, tpp::Name("speed"));
+    EXPECT_EQ(speed, tpp::Name::find("speed"));
+    EXPECT_FALSE(tpp::Name::find("never interned name").isValid());
+    EXPECT_EQ(speed.hash(), tpp::detail::hashString("speed"));
+
+    tpp::PropertyMap map {};
+    map.set(speed, 2.5f);
+
+    EXPECT_EQ(map.get<float>(speed), 2.5f);
+    EXPECT_EQ(map.get<float>("speed"), 2.5f);
+    EXPECT_FALSE(map.has<int>(speed));
+    EXPECT_FALSE(map.has<float>(tpp::Name {}));
+}
+
+TEST(PropertyMapTests, MovedFromMapIsEmpty)
+{
+    std::pmr::monotonic_buffer_resource arena {};
+
+    tpp::PropertyMap map {};
+    map.set("x", 1);
+
+    tpp::PropertyMap moved { std::move(map) };
+    EXPECT_EQ(moved.get<int>("x"), 1);
+    EXPECT_EQ(map.size(), 0u);
+    EXPECT_FALSE(map.get<int>("x").has_value());
+    EXPECT_FALSE(map.has<int>("x"));
+    map.remove(tpp::Name("x"));
+
+    // Moved from maps can be reused
+    map.set("y", 2);
+    EXPECT_EQ(map.get<int>("y"), 2);
+
+    tpp::PropertyMap assigned {};
+    assigned = std::move(map);
+    EXPECT_EQ(assigned.get<int>("y"), 2);
+    EXPECT_FALSE(map.get<int>("y").has_value());
+
+    // With a different allocator the slots are copied, the source is still emptied
+    tpp::PropertyMap other_resource { std::move(moved), tpp::PropertyMap::allocator_type { &arena } };
+    EXPECT_EQ(other_resource.get<int>("x"), 1);
+    EXPECT_FALSE(moved.get<int>("x").has_value());
+    EXPECT_EQ(moved.size(), 0u);
+}
+
+TEST(PropertyMapTests, ClearNameTable)
+{
+    {
+        tpp::PropertyMap map {};
+        map.set("cleared key", 1);
+        EXPECT_TRUE(tpp::Name::find("cleared key").isValid());
+        EXPECT_GT(tpp::Name::getInternedCount(), 0u);
+    }
+
+    tpp::Name::clearTable();
+    EXPECT_EQ(tpp::Name::getInternedCount(), 0u);
+    EXPECT_FALSE(tpp::Name::find("cleared key").isValid());
+
+    tpp::Name again { "cleared key" };
+    EXPECT_EQ(again, tpp::Name::find("cleared key"));
+    EXPECT_EQ(again.str(), "cleared key");
+    EXPECT_EQ(tpp::Name::getInternedCount(), 1u);
+}
+
+TEST(PropertyMapTests, CompileTimeKeys)
+{
+    constexpr tpp::Key damage { "damage" };
+    static_assert(damage.hash() == tpp::detail::hashString("damage"));
+
+    tpp::PropertyMap map {};
+    map.set("damage", 10);
+    map.set("walkable", true);
+
+    EXPECT_EQ(map.get<int>(damage), 10);
+    EXPECT_TRUE(map.has<bool>(TPP_KEY("walkable")));
+    EXPECT_FALSE(map.has<bool>(TPP_KEY("flying")));
+}
+
+struct BoundTile
+{
+    bool flag = false;
+    int number = -1;
+    float value = 0.0f;
+    std::string text = "default";
+};
+
+template <>
+struct tpp::PropertyBinding<BoundTile>
+{
+    static constexpr auto fields = std::make_tuple(
+        tpp::bindField("BoolProp", &BoundTile::flag),
+        tpp::bindField("IntProp", &BoundTile::number),
+        tpp::bindField("FloatProp", &BoundTile::value),
+        tpp::bindField("StringProp", &BoundTile::text));
+};
+
+TEST(PropertyMapTests, BindTileProperties)
+{
+    auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset3.tsx");
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    std::vector<BoundTile> tiles = tpp::bindTileProperties<BoundTile>(*result);
+    ASSERT_EQ(tiles.size(), result->getTileCount());
+
+    EXPECT_TRUE(tiles[1].flag);
+    EXPECT_EQ(tiles[1].number, 42);
+    EXPECT_EQ(tiles[1].value, 3.14f);
+    EXPECT_EQ(tiles[1].text, "Hello World");
+
+    // Tiles without properties keep the defaults
+    EXPECT_EQ(tiles[0].number, -1);
+    EXPECT_EQ(tiles[0].text, "default");
+}
+
+TEST(PropertyMapTests, GrowAndRemove)
+{
+    tpp::PropertyMap map {};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        map.set("key" + std::to_string(i), i);
+    }
+    ASSERT_EQ(map.size(), 100);
+
+    // Removing every other key shifts the probe runs back, the rest must stay reachable
+    for (int i = 0; i < 100; i += 2)
+    {
+        map.remove("key" + std::to_string(i));
+    }
+    ASSERT_EQ(map.size(), 50);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        auto value = map.get<int>("key" + std::to_string(i));
+        if (i % 2 == 0)
+            EXPECT_FALSE(value.has_value()) << i;
+        else
+            EXPECT_EQ(value, i);
+    }
+
+    size_t visited = 0;
+    map.forEach([&](tpp::Name, const tpp::CustomProperty&)
+        { ++visited; });
+    EXPECT_EQ(visited, 50);
+}
+
 TEST(TileMapTests, MapWith2Layers)
 {
     auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx");
@@ -103,15 +310,63 @@ TEST(TileMapTests, MapWith2Layers)
     auto& layer2 = result->getTileLayers().at(1);
 
     tpp::UVec2 expected { 4, 2 };
-    ASSERT_EQ(layer1.tile_ids.size(), expected);
+    ASSERT_EQ(layer1.size(), expected);
 
-    EXPECT_EQ(layer1.tile_ids.at(3, 0).getTileset(), 0);
-    EXPECT_EQ(layer1.tile_ids.at(3, 0).getId(), 3);
+    EXPECT_EQ(result->getTileSetIndex(layer1.at(3, 0)), 0);
+    EXPECT_EQ(result->getTileIndex(layer1.at(3, 0)), 3);
 
-    for (auto tile : layer2.tile_ids)
+    for (auto tile : *layer2.getDense())
     {
-        EXPECT_EQ(tile.getTileset(), 1);
-        EXPECT_EQ(tile.getId(), 1);
+        EXPECT_EQ(result->getTileSetIndex(tile), 1);
+        EXPECT_EQ(result->getTileIndex(tile), 1);
+    }
+}
+
+TEST(TileMapTests, ResolvedTiles)
+{
+    auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx");
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    // 2 tilesets of 4 tiles, plus the empty gid 0
+    ASSERT_EQ(result->getResolvedTiles().size(), 9);
+
+    const tpp::ResolvedTile& tile = result->resolve(tpp::TileID(6 | tpp::TileID::FLIPPED_HORIZONTALLY_FLAG));
+    ASSERT_TRUE(tile.isValid());
+    EXPECT_EQ(tile.tileset, 1);
+    EXPECT_EQ(tile.tile_index, 1);
+    EXPECT_EQ(tile.rect.start, (tpp::UVec2 { 4, 0 }));
+    EXPECT_EQ(tile.rect.size, (tpp::UVec2 { 4, 4 }));
+    EXPECT_FLOAT_EQ(tile.uvs.u0, 0.25f);
+    EXPECT_FLOAT_EQ(tile.uvs.v0, 0.0f);
+    EXPECT_FLOAT_EQ(tile.uvs.u1, 0.5f);
+    EXPECT_FLOAT_EQ(tile.uvs.v1, 1.0f);
+    EXPECT_EQ(tile.properties, nullptr);
+    EXPECT_EQ(tile.flags, tpp::ResolvedTile::VALID);
+
+    EXPECT_FALSE(result->resolve(tpp::TileID(0)).isValid());
+    EXPECT_FALSE(result->resolve(tpp::TileID(100)).isValid());
+    EXPECT_EQ(result->getTileSetIndex(tpp::TileID(100)), tpp::TileMap::INVALID_TILESET);
+}
+
+TEST(TileMapTests, TileSetAfterLayer)
+{
+    for (auto mode : { tpp::ValidationMode::Validate, tpp::ValidationMode::Trusted })
+    {
+        tpp::LoadOptions options {};
+        options.validation = mode;
+
+        auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map11.tmx", options);
+        ASSERT_TRUE(result.has_value()) << result.error().message;
+
+        ASSERT_EQ(result->getTileSets().size(), 2);
+        ASSERT_EQ(result->getResolvedTiles().size(), 9);
+
+        const tpp::ResolvedTile& tile = result->resolve(tpp::TileID(6));
+        ASSERT_TRUE(tile.isValid());
+        EXPECT_EQ(tile.tileset, 1);
+        EXPECT_EQ(tile.tile_index, 1);
+        EXPECT_EQ(result->getTileSetIndex(result->getTileLayers().at(0).at(0, 0)), 0);
+        EXPECT_EQ(result->getTileSetIndex(result->getTileLayers().at(1).at(3, 0)), 1);
     }
 }
 
@@ -141,8 +396,6 @@ TEST(TileMapTests, FindLayer)
     EXPECT_TRUE(found != nullptr);
 }
 
-#include <bitset>
-
 TEST(TileMapTests, FlippedTiles)
 {
     auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map2.tmx");
@@ -150,16 +403,54 @@ TEST(TileMapTests, FlippedTiles)
 
     auto& layer = result->getTileLayers().at(0);
 
-    for (auto& tile : layer.tile_ids)
+    for (auto& tile : *layer.getDense())
     {
-        std::cout << std::bitset<32>(tile.getId()) << std::endl;
-        // EXPECT_EQ(tile.getId(), 0);
+        EXPECT_EQ(tile.getGid(), 1);
     }
 
     // Check flipped tiles
-    EXPECT_TRUE(layer.tile_ids.at(1, 0).isFlippedHorizontally());
-    EXPECT_TRUE(layer.tile_ids.at(0, 1).isFlippedVertically());
-    EXPECT_TRUE(layer.tile_ids.at(1, 1).isFlippedHorizontally() && layer.tile_ids.at(1, 1).isFlippedVertically());
+    EXPECT_TRUE(layer.at(1, 0).isFlippedHorizontally());
+    EXPECT_TRUE(layer.at(0, 1).isFlippedVertically());
+    EXPECT_TRUE(layer.at(1, 1).isFlippedHorizontally() && layer.at(1, 1).isFlippedVertically());
+    EXPECT_FALSE(layer.at(1, 1).isFlippedDiagonally());
+
+    EXPECT_EQ(result->getTileSetIndex(layer.at(1, 1)), 0);
+    EXPECT_EQ(result->getTileIndex(layer.at(1, 1)), 0);
+}
+
+TEST(TileMapTests, OrientationUVs)
+{
+    tpp::TileID rotated { 1 | tpp::TileID::FLIPPED_HORIZONTALLY_FLAG | tpp::TileID::FLIPPED_DIAGONALLY_FLAG | tpp::TileID::ROTATED_HEXAGONAL_120_FLAG };
+    EXPECT_EQ(rotated.getOrientation(), 5);
+    EXPECT_EQ(tpp::TileID(1).getOrientation(), 0);
+
+    tpp::UVRect uvs { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    // Rotated 90 degrees clockwise: the bottom left of the tile is drawn at the top left
+    tpp::UVQuad quad = tpp::orientUVs(uvs, rotated.getOrientation());
+    EXPECT_EQ(quad.corners[0].u, 0.0f);
+    EXPECT_EQ(quad.corners[0].v, 1.0f);
+    EXPECT_EQ(quad.corners[1].u, 0.0f);
+    EXPECT_EQ(quad.corners[1].v, 0.0f);
+
+    // Flipped vertically: the bottom right is drawn at the top right
+    quad = tpp::orientUVs(uvs, 2);
+    EXPECT_EQ(quad.corners[1].u, 1.0f);
+    EXPECT_EQ(quad.corners[1].v, 1.0f);
+
+    tpp::LoadOptions options {};
+    options.orientation_uvs = true;
+
+    auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    const tpp::TileSet& tileset = result->getTileSets().at(1);
+    ASSERT_EQ(tileset.getTileUVQuads().size(), tileset.getTileCount() * tpp::TileID::ORIENTATION_COUNT);
+
+    const tpp::ResolvedTile& tile = result->resolve(tpp::TileID(6));
+    ASSERT_NE(tile.uv_quads, nullptr);
+    EXPECT_FLOAT_EQ(tile.uv_quads[5].corners[0].u, tile.uvs.u0);
+    EXPECT_FLOAT_EQ(tile.uv_quads[5].corners[0].v, tile.uvs.v1);
 }
 
 TEST(TileMapTests, EmptyTiles)
@@ -167,8 +458,405 @@ TEST(TileMapTests, EmptyTiles)
     auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map3.tmx");
     ASSERT_TRUE(result.has_value()) << result.error().message;
 
-    for (auto& tiles : result->getTileLayers().at(0).tile_ids)
+    for (auto& tiles : *result->getTileLayers().at(0).getDense())
     {
         EXPECT_FALSE(tiles.isValid());
     }
-}
\ No newline at end of file
+}
+
+TEST(LoadOptionsTests, SkipImagesKeepsSize)
+{
+    tpp::LoadOptions options {};
+    options.load_images = false;
+
+    auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset.tsx", options);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    EXPECT_EQ(result->getImage().getData(), nullptr);
+    EXPECT_EQ(result->getImage().getSize(), (tpp::UVec2 { 18, 18 }));
+    EXPECT_EQ(result->getTileCount(), 16);
+}
+
+TEST(LoadOptionsTests, SkipPropertiesAndAnimations)
+{
+    tpp::LoadOptions options {};
+    options.load_properties = false;
+    options.load_animations = false;
+
+    auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset3.tsx", options);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    EXPECT_EQ(result->getTileAnimation(0), nullptr);
+    EXPECT_EQ(result->getTileProperties(1), nullptr);
+
+    auto map = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+    ASSERT_TRUE(map.has_value()) << map.error().message;
+
+    EXPECT_EQ(map->getProperties(), nullptr);
+    EXPECT_EQ(map->getTileLayers().at(0).custom_properties, nullptr);
+}
+
+TEST(LoadOptionsTests, LayerFilter)
+{
+    tpp::LoadOptions options {};
+    options.layer_filter = [](std::string_view name)
+    { return name == "NamedLayer"; };
+
+    auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    ASSERT_EQ(result->getTileLayers().size(), 1);
+    EXPECT_EQ(result->getTileLayers().at(0).name, "NamedLayer");
+}
+
+TEST(LoadOptionsTests, MemoryResource)
+{
+    std::pmr::monotonic_buffer_resource arena {};
+    test_support::CountingResource counting { &arena };
+
+    tpp::LoadOptions options {};
+    options.memory_resource = &counting;
+
+    {
+        auto tileset = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset3.tsx", options);
+        ASSERT_TRUE(tileset.has_value()) << tileset.error().message;
+        EXPECT_GT(counting.allocations, 0);
+
+        auto* props = tileset->getTileProperties(1);
+        ASSERT_TRUE(props != nullptr);
+        EXPECT_EQ(props->get_allocator().resource(), &counting);
+        EXPECT_EQ(props->get<std::string>("StringProp"), "Hello World");
+
+        auto* anim = tileset->getTileAnimation(0);
+        ASSERT_TRUE(anim != nullptr);
+        EXPECT_EQ(anim->frames.size(), 2);
+    }
+
+    auto map = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+    ASSERT_TRUE(map.has_value()) << map.error().message;
+
+    auto& layer = map->getTileLayers().at(1);
+    EXPECT_EQ(layer.name, "NamedLayer");
+
+    ASSERT_TRUE(map->getProperties() != nullptr);
+    EXPECT_EQ(map->getProperties()->get_allocator().resource(), &counting);
+    EXPECT_TRUE(map->getProperties()->has<float>("TestProperty"));
+}
+
+TEST(LoadOptionsTests, RetainSource)
+{
+    for (bool retain : { false, true })
+    {
+        tpp::LoadOptions options {};
+        options.retain_source = retain;
+
+        auto map = tpp::TileMap::fromTMX("tiledcpp_tests/files/map7.tmx", options);
+        ASSERT_TRUE(map.has_value()) << map.error().message;
+
+        auto& layer = map->getTileLayers().at(0);
+        EXPECT_EQ(layer.name, "Walls & Doors");
+        EXPECT_EQ(map->findTileLayer("Walls & Doors"), &layer);
+
+        auto* props = map->getProperties();
+        ASSERT_TRUE(props != nullptr);
+        EXPECT_EQ(props->get<int>("Level"), 7);
+
+        // Both string types work whether the value is owned or retained
+        EXPECT_TRUE(props->has<std::string_view>("Title"));
+        EXPECT_EQ(props->get<std::string_view>("Title"), "The \"Keep\" & its long courtyard");
+        EXPECT_EQ(props->get<std::string>("Title"), "The \"Keep\" & its long courtyard");
+        EXPECT_EQ(layer.custom_properties->get<std::string_view>("Note"), "plain text, no entities at all");
+
+        // Retained strings without entities point into the source kept by the map, which stays unmodified
+        std::string_view note = layer.custom_properties->get<std::string_view>("Note").value();
+        std::string_view source = map->getSource();
+        EXPECT_EQ(retain, !source.empty() && note.data() >= source.data() && note.data() < source.data() + source.size());
+
+        if (retain)
+        {
+            std::ifstream file { "tiledcpp_tests/files/map7.tmx", std::ios::binary };
+            std::string contents { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+            EXPECT_EQ(source, contents);
+        }
+
+        // Names are owned, so layers moved out of the map keep them
+        tpp::TileLayer moved = std::move(map->getTileLayers().at(0));
+        map = tpp::Result<tpp::TileMap>(tl::unexpect, tpp::Error { "destroyed" });
+        EXPECT_EQ(moved.name, "Walls & Doors");
+    }
+}
+
+TEST(LoaderTests, ReusedLoaderMatchesFromTMX)
+{
+    tpp::LoadOptions options {};
+    options.layer_storage = tpp::LayerStorage::Compact16;
+
+    tpp::Loader loader { options };
+
+    // Alternate between maps so that every buffer gets reused with different contents
+    for (int i = 0; i < 2; ++i)
+    {
+        for (const char* path : { "tiledcpp_tests/files/map1.tmx", "tiledcpp_tests/files/map4.tmx" })
+        {
+            auto expected = tpp::TileMap::fromTMX(path, options);
+            auto result = loader.loadMap(path);
+            ASSERT_TRUE(expected.has_value()) << expected.error().message;
+            ASSERT_TRUE(result.has_value()) << result.error().message;
+
+            EXPECT_EQ(result->getTileSets().size(), expected->getTileSets().size());
+            ASSERT_EQ(result->getTileLayers().size(), expected->getTileLayers().size());
+
+            for (size_t l = 0; l < result->getTileLayers().size(); ++l)
+            {
+                auto& layer = result->getTileLayers()[l];
+                auto& expected_layer = expected->getTileLayers()[l];
+
+                EXPECT_EQ(layer.storage(), expected_layer.storage());
+                ASSERT_EQ(layer.size(), expected_layer.size());
+
+                for (uint32_t y = 0; y < layer.size().y; ++y)
+                {
+                    for (uint32_t x = 0; x < layer.size().x; ++x)
+                    {
+                        EXPECT_EQ(layer.at(x, y), expected_layer.at(x, y));
+                    }
+                }
+            }
+        }
+
+        loader.releaseBuffers();
+    }
+
+    auto tileset = loader.loadTileSet("tiledcpp_tests/files/tileset3.tsx");
+    ASSERT_TRUE(tileset.has_value()) << tileset.error().message;
+    EXPECT_TRUE(tileset->getTileAnimation(0) != nullptr);
+
+    EXPECT_FALSE(loader.loadMap("tiledcpp_tests/files/missing.tmx").has_value());
+}
+
+TEST(TileMapTests, ProbeMapInfo)
+{
+    auto result = tpp::TileMap::probe("tiledcpp_tests/files/map1.tmx");
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    EXPECT_EQ(result->map_size, (tpp::UVec2 { 4, 2 }));
+    EXPECT_EQ(result->map_tile_size, (tpp::UVec2 { 4, 4 }));
+
+    ASSERT_EQ(result->tile_sets.size(), 2);
+    EXPECT_EQ(result->tile_sets.at(0).first_gid, 1);
+    EXPECT_EQ(result->tile_sets.at(1).first_gid, 5);
+    EXPECT_EQ(result->tile_sets.at(1).source, tpp::detail::resolvePath("tiledcpp_tests/files", "tileset5.tsx"));
+
+    ASSERT_TRUE(result->custom_properties != nullptr);
+    EXPECT_TRUE(result->custom_properties->has<float>("TestProperty"));
+}
+
+TEST(TileMapTests, ProbeLongHeader)
+{
+    // Enough properties to push the first layer past the first read of the file
+    std::string path = testing::TempDir() + "long_header.tmx";
+    {
+        std::ofstream file { path, std::ios::binary };
+        file << "<map width=\"2\" height=\"3\" tilewidth=\"4\" tileheight=\"4\">\n <properties>\n";
+        for (int i = 0; i < 1000; ++i)
+        {
+            file << "  <property name=\"p" << i << "\" type=\"int\" value=\"" << i << "\"/>\n";
+        }
+        file << " </properties>\n <layer width=\"2\" height=\"3\"><data encoding=\"csv\">0,0,0,0,0,0</data></layer>\n</map>\n";
+    }
+
+    auto result = tpp::TileMap::probe(path);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    EXPECT_EQ(result->map_size, (tpp::UVec2 { 2, 3 }));
+    ASSERT_TRUE(result->custom_properties != nullptr);
+    EXPECT_EQ(result->custom_properties->get<int>("p999"), 999);
+}
+
+TEST(TileMapTests, Base64Data)
+{
+    auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map4.tmx");
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+
+    auto& layer = result->getTileLayers().at(0);
+    EXPECT_EQ(result->getTileSetIndex(layer.at(3, 0)), 0);
+    EXPECT_EQ(result->getTileIndex(layer.at(3, 0)), 3);
+    EXPECT_EQ(result->getTileSetIndex(layer.at(1, 1)), 1);
+    EXPECT_EQ(result->getTileIndex(layer.at(1, 1)), 1);
+}
+
+TEST(LoadOptionsTests, RegionOfInterest)
+{
+    tpp::LoadOptions options {};
+    options.region = tpp::URect { { 2, 1 }, { 8, 8 } };
+
+    for (const char* path : { "tiledcpp_tests/files/map1.tmx", "tiledcpp_tests/files/map4.tmx" })
+    {
+        auto result = tpp::TileMap::fromTMX(path, options);
+        ASSERT_TRUE(result.has_value()) << result.error().message;
+
+        auto& layer = result->getTileLayers().at(0);
+
+        // Region is clamped to the map size
+        EXPECT_EQ(layer.origin, (tpp::UVec2 { 2, 1 }));
+        ASSERT_EQ(layer.size(), (tpp::UVec2 { 2, 1 }));
+
+        // Map tiles (2, 1) and (3, 1): gids 7 and 8
+        EXPECT_EQ(result->getTileSetIndex(layer.at(0, 0)), 1);
+        EXPECT_EQ(result->getTileIndex(layer.at(0, 0)), 2);
+        EXPECT_EQ(result->getTileIndex(layer.at(1, 0)), 3);
+    }
+}
+
+TEST(ValidationTests, GidOutOfRange)
+{
+    auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map5.tmx");
+    EXPECT_FALSE(result.has_value());
+
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+
+    auto trusted = tpp::TileMap::fromTMX("tiledcpp_tests/files/map5.tmx", options);
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+    EXPECT_EQ(trusted->getTileIndex(trusted->getTileLayers().at(0).at(0, 1)), 2);
+
+    // Gids outside of every tileset are kept, but do not resolve to a tileset
+    auto out_of_range = trusted->getTileLayers().at(0).at(1, 1);
+    EXPECT_EQ(out_of_range.getGid(), 9);
+    EXPECT_EQ(trusted->getTileSetIndex(out_of_range), tpp::TileMap::INVALID_TILESET);
+}
+
+TEST(ValidationTests, MissingLayerData)
+{
+    auto result = tpp::TileMap::fromTMX("tiledcpp_tests/files/map6.tmx");
+    EXPECT_FALSE(result.has_value());
+
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+
+    // Missing tiles are left empty
+    auto trusted = tpp::TileMap::fromTMX("tiledcpp_tests/files/map6.tmx", options);
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+    EXPECT_FALSE(trusted->getTileLayers().at(0).at(1, 1).isValid());
+}
+
+TEST(ValidationTests, ProbeMatchesFromTMX)
+{
+    // map8.tmx has no tileheight
+    EXPECT_FALSE(tpp::TileMap::fromTMX("tiledcpp_tests/files/map8.tmx").has_value());
+    EXPECT_FALSE(tpp::TileMap::probe("tiledcpp_tests/files/map8.tmx").has_value());
+    EXPECT_FALSE(tpp::TileMap::probe("tiledcpp_tests/files/tileset4.tsx").has_value());
+
+    std::pmr::monotonic_buffer_resource arena {};
+
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+    options.memory_resource = &arena;
+
+    auto trusted = tpp::TileMap::probe("tiledcpp_tests/files/map8.tmx", options);
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+    EXPECT_EQ(trusted->map_tile_size, (tpp::UVec2 { 4, 0 }));
+
+    ASSERT_TRUE(trusted->custom_properties != nullptr);
+    EXPECT_EQ(trusted->custom_properties->get<int>("level"), 3);
+    EXPECT_EQ(trusted->custom_properties->get_allocator().resource(), &arena);
+}
+
+TEST(ValidationTests, OutOfRangeTilesAndProperties)
+{
+    // tileset6.tsx has a tile id past the tile count and an unknown property type
+    EXPECT_FALSE(tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset6.tsx").has_value());
+
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+    options.load_images = false;
+
+    auto trusted = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset6.tsx", options);
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+    EXPECT_EQ(trusted->getTileProperties(0), nullptr);
+
+    const tpp::PropertyMap* properties = trusted->getTileProperties(1);
+    ASSERT_NE(properties, nullptr);
+    EXPECT_EQ(properties->get<float>("speed"), 2.5f);
+    EXPECT_EQ(properties->get<int>("target"), 7);
+    EXPECT_EQ(properties->get<std::string>("notes"), "first line\nsecond line");
+    EXPECT_FALSE(properties->get<std::string>("position").has_value());
+}
+
+TEST(ValidationTests, ZeroColumns)
+{
+    EXPECT_FALSE(tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset7.tsx").has_value());
+
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+
+    // Tiles without a grid keep empty rects
+    auto trusted = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset7.tsx", options);
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+    ASSERT_EQ(trusted->getTileRects().size(), 4u);
+    EXPECT_EQ(trusted->getTileRects()[3].size, (tpp::UVec2 { 0, 0 }));
+}
+
+TEST(ValidationTests, NegativeMarginAndSpacing)
+{
+    EXPECT_FALSE(tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset8.tsx").has_value());
+
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+
+    auto trusted = tpp::TileSet::fromTSX("tiledcpp_tests/files/tileset8.tsx", options);
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+    ASSERT_EQ(trusted->getTileRects().size(), 4u);
+    EXPECT_EQ(trusted->getTileRects()[3].start, (tpp::UVec2 { 12, 0 }));
+}
+
+TEST(ValidationTests, LayerDataPastMapSize)
+{
+    EXPECT_FALSE(tpp::TileMap::fromTMX("tiledcpp_tests/files/map9.tmx").has_value());
+
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+
+    auto trusted = tpp::TileMap::fromTMX("tiledcpp_tests/files/map9.tmx", options);
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+    EXPECT_EQ(trusted->getTileIndex(trusted->getTileLayers().at(0).at(1, 1)), 3);
+}
+
+TEST(ValidationTests, GidRangeOverflow)
+{
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+
+    // The last tiles of map10.tmx would need gids past the flag bits
+    EXPECT_FALSE(tpp::TileMap::fromTMX("tiledcpp_tests/files/map10.tmx").has_value());
+    EXPECT_FALSE(tpp::TileMap::fromTMX("tiledcpp_tests/files/map10.tmx", options).has_value());
+}
+
+TEST(ValidationTests, WrongExtension)
+{
+    auto result = tpp::TileSet::fromTSX("tiledcpp_tests/files/map1.tmx");
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(ValidationTests, TrustedMatchesValidated)
+{
+    tpp::LoadOptions options {};
+    options.validation = tpp::ValidationMode::Trusted;
+
+    auto validated = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx");
+    auto trusted = tpp::TileMap::fromTMX("tiledcpp_tests/files/map1.tmx", options);
+    ASSERT_TRUE(validated.has_value()) << validated.error().message;
+    ASSERT_TRUE(trusted.has_value()) << trusted.error().message;
+
+    ASSERT_EQ(validated->getTileLayers().size(), trusted->getTileLayers().size());
+
+    auto& a = validated->getTileLayers().at(0);
+    auto& b = trusted->getTileLayers().at(0);
+    for (uint32_t y = 0; y < a.size().y; ++y)
+    {
+        for (uint32_t x = 0; x < a.size().x; ++x)
+        {
+            EXPECT_EQ(a.at(x, y).getRaw(), b.at(x, y).getRaw());
+        }
+    }
+}
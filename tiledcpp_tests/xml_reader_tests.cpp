@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <tiledcpp/detail/xml_reader.hpp>
+
+using tpp::detail::XmlAttribute;
+using tpp::detail::XmlElement;
+
+TEST(XmlReaderTests, LookupNames)
+{
+    EXPECT_EQ(tpp::detail::lookupElement("tileset"), XmlElement::TileSet);
+    EXPECT_EQ(tpp::detail::lookupElement("data"), XmlElement::Data);
+    EXPECT_EQ(tpp::detail::lookupElement("objectgroup"), XmlElement::Unknown);
+
+    EXPECT_EQ(tpp::detail::lookupAttribute("firstgid"), XmlAttribute::FirstGid);
+    EXPECT_EQ(tpp::detail::lookupAttribute("tileid"), XmlAttribute::TileId);
+    EXPECT_EQ(tpp::detail::lookupAttribute("opacity"), XmlAttribute::Unknown);
+}
+
+TEST(XmlReaderTests, ReadNestedTags)
+{
+    std::string_view text = R"(<?xml version="1.0"?>
+<!-- comment -->
+<map width="4" height='2' unknown="x">
+ <objectgroup><object id="1"/></objectgroup>
+ <layer name="A &amp; B"><data encoding="csv">1,2</data></layer>
+</map>)";
+
+    tpp::detail::XmlReader reader { text };
+    tpp::detail::XmlTag map {};
+
+    ASSERT_TRUE(reader.nextChild(map));
+    EXPECT_EQ(map.element, XmlElement::Map);
+    EXPECT_EQ(map.getInt(XmlAttribute::Width), 4);
+    EXPECT_EQ(map.getInt(XmlAttribute::Height), 2);
+    EXPECT_FALSE(map.has(XmlAttribute::Name));
+
+    tpp::detail::XmlTag child {};
+    ASSERT_TRUE(reader.nextChild(child));
+    EXPECT_EQ(child.element, XmlElement::Unknown);
+    reader.skip(child);
+
+    ASSERT_TRUE(reader.nextChild(child));
+    EXPECT_EQ(child.element, XmlElement::Layer);
+    EXPECT_EQ(tpp::detail::decodeEntities(child.get(XmlAttribute::Name)), "A & B");
+
+    tpp::detail::XmlTag data {};
+    ASSERT_TRUE(reader.nextChild(data));
+    EXPECT_EQ(data.get(XmlAttribute::Encoding), "csv");
+    EXPECT_EQ(reader.readText(data), "1,2");
+
+    EXPECT_FALSE(reader.nextChild(data));
+    EXPECT_FALSE(reader.nextChild(child));
+    EXPECT_FALSE(reader.nextChild(map));
+    EXPECT_FALSE(reader.hasError());
+}
+
+TEST(XmlReaderTests, MalformedTag)
+{
+    tpp::detail::XmlReader reader { "<map width=\"4>" };
+    tpp::detail::XmlTag tag {};
+
+    EXPECT_FALSE(reader.nextChild(tag));
+    EXPECT_TRUE(reader.hasError());
+}
+
+TEST(XmlReaderTests, DecodeEntities)
+{
+    EXPECT_EQ(tpp::detail::decodeEntities("&lt;a&gt; &quot;b&apos; &#65;&#x42;"), "<a> \"b' AB");
+    EXPECT_EQ(tpp::detail::decodeEntities("plain"), "plain");
+}
+
+TEST(XmlReaderTests, DecodeEntitiesInPlace)
+{
+    std::string text = "&lt;&#x1F600;&#233;&amp;c";
+    size_t size = tpp::detail::decodeEntities(text, text.data());
+    EXPECT_EQ(text.substr(0, size), "<\xF0\x9F\x98\x80\xC3\xA9&c");
+}